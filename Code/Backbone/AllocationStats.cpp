@@ -0,0 +1,243 @@
+#include "AllocationStats.hpp"
+
+//~~[[
+
+/// The slot of the calling thread.
+///
+/// All but the last slot are claimed exclusively by a single thread, which
+/// then can update its counters without atomic read-modify-write operations.
+/// When all of them are taken, threads share the last slot.
+struct alloc_stats_thread_slot
+{
+  uint32 Index;
+  bool32 IsExclusive;
+
+  alloc_stats_thread_slot();
+  ~alloc_stats_thread_slot();
+};
+
+/// Bit N is set while slot N is claimed by a thread.
+static std::atomic<uint32> AllocStatsClaimedSlots{ 0 };
+
+alloc_stats_thread_slot::alloc_stats_thread_slot()
+{
+  Index = AllocStats_NumThreadSlots - 1;
+  IsExclusive = false;
+
+  auto Claimed = AllocStatsClaimedSlots.load(std::memory_order_relaxed);
+  for(uint32 Candidate = 0; Candidate < AllocStats_NumThreadSlots - 1; ++Candidate)
+  {
+    auto const Bit = uint32(1) << Candidate;
+    if(Claimed & Bit)
+      continue;
+
+    Claimed = AllocStatsClaimedSlots.fetch_or(Bit, std::memory_order_acquire);
+    if((Claimed & Bit) == 0)
+    {
+      Index = Candidate;
+      IsExclusive = true;
+      break;
+    }
+  }
+}
+
+alloc_stats_thread_slot::~alloc_stats_thread_slot()
+{
+  if(IsExclusive)
+    AllocStatsClaimedSlots.fetch_and(~(uint32(1) << Index), std::memory_order_release);
+}
+
+static thread_local alloc_stats_thread_slot AllocStatsThreadSlot;
+
+template<typename T>
+static void
+AllocStatsAdd(std::atomic<T>* Counter, T Value, bool32 IsExclusive)
+{
+  // With a single writer, a plain load and store is enough. Readers only
+  // need to see a value that is not torn.
+  if(IsExclusive)
+    Counter->store(Counter->load(std::memory_order_relaxed) + Value, std::memory_order_relaxed);
+  else
+    Counter->fetch_add(Value, std::memory_order_relaxed);
+}
+
+static void
+AllocStatsUpdatePeak(allocation_stats* Stats, int64 Candidate)
+{
+  auto Peak = Stats->PeakBytes.load(std::memory_order_relaxed);
+  while(Candidate > Peak && !Stats->PeakBytes.compare_exchange_weak(Peak, Candidate, std::memory_order_relaxed))
+  {
+  }
+}
+
+/// Account Delta bytes to the live size of the given Slot.
+static void
+AllocStatsAddLiveBytes(allocation_stats* Stats, impl_alloc_stats_slot* Slot, int64 Delta, bool32 IsExclusive)
+{
+  AllocStatsAdd(&Slot->PendingBytes, Delta, IsExclusive);
+  auto const Pending = Slot->PendingBytes.load(std::memory_order_relaxed);
+  if(Pending > Slot->PendingPeakBytes.load(std::memory_order_relaxed))
+    Slot->PendingPeakBytes.store(Pending, std::memory_order_relaxed);
+
+  if(Pending < AllocStats_PeakGranularity && Pending > -AllocStats_PeakGranularity)
+    return;
+
+  // Fold the pending bytes into the shared live size. The highest point the
+  // slot reached in the meantime is a candidate for the peak.
+  auto const PendingPeak = Slot->PendingPeakBytes.exchange(0, std::memory_order_relaxed);
+  auto const Folded = Slot->PendingBytes.exchange(0, std::memory_order_relaxed);
+  auto const LiveBefore = Stats->LiveBytes.fetch_add(Folded, std::memory_order_relaxed);
+  AllocStatsUpdatePeak(Stats, LiveBefore + Max(PendingPeak, Folded));
+}
+
+auto
+::AllocStatsInit(allocation_stats* Stats)
+  -> void
+{
+  Assert(Stats);
+  for(auto& PaddedSlot : Stats->Slots)
+  {
+    auto& Slot = PaddedSlot.Value;
+    Slot.NumAllocations.store(0, std::memory_order_relaxed);
+    Slot.NumFrees.store(0, std::memory_order_relaxed);
+    Slot.AllocatedBytes.store(0, std::memory_order_relaxed);
+    Slot.FreedBytes.store(0, std::memory_order_relaxed);
+    Slot.PendingBytes.store(0, std::memory_order_relaxed);
+    Slot.PendingPeakBytes.store(0, std::memory_order_relaxed);
+    for(auto& Count : Slot.SizeHistogram)
+      Count.store(0, std::memory_order_relaxed);
+  }
+  Stats->LiveBytes.store(0, std::memory_order_relaxed);
+  Stats->PeakBytes.store(0, std::memory_order_relaxed);
+  for(auto& Committed : Stats->CommittedBytes)
+    Committed.store(0, std::memory_order_relaxed);
+}
+
+auto
+::AllocStatsRecordAllocation(allocation_stats* Stats, memory_size Size)
+  -> void
+{
+  if(Stats == nullptr)
+    return;
+
+  auto const& ThreadSlot = AllocStatsThreadSlot;
+  auto Slot = &Stats->Slots[ThreadSlot.Index].Value;
+  AllocStatsAdd(&Slot->NumAllocations, uint64(1), ThreadSlot.IsExclusive);
+  AllocStatsAdd(&Slot->AllocatedBytes, ToBytes(Size), ThreadSlot.IsExclusive);
+  AllocStatsAdd(&Slot->SizeHistogram[AllocStatsHistogramBucket(Size)], uint64(1), ThreadSlot.IsExclusive);
+  AllocStatsAddLiveBytes(Stats, Slot, Convert<int64>(ToBytes(Size)), ThreadSlot.IsExclusive);
+}
+
+auto
+::AllocStatsRecordFree(allocation_stats* Stats, memory_size Size)
+  -> void
+{
+  if(Stats == nullptr)
+    return;
+
+  auto const& ThreadSlot = AllocStatsThreadSlot;
+  auto Slot = &Stats->Slots[ThreadSlot.Index].Value;
+  AllocStatsAdd(&Slot->NumFrees, uint64(1), ThreadSlot.IsExclusive);
+  AllocStatsAdd(&Slot->FreedBytes, ToBytes(Size), ThreadSlot.IsExclusive);
+  AllocStatsAddLiveBytes(Stats, Slot, -Convert<int64>(ToBytes(Size)), ThreadSlot.IsExclusive);
+}
+
+auto
+::AllocStatsRecordResize(allocation_stats* Stats, memory_size OldSize, memory_size NewSize)
+  -> void
+{
+  if(Stats == nullptr || OldSize == NewSize)
+    return;
+
+  auto const& ThreadSlot = AllocStatsThreadSlot;
+  auto Slot = &Stats->Slots[ThreadSlot.Index].Value;
+  if(NewSize > OldSize)
+    AllocStatsAdd(&Slot->AllocatedBytes, ToBytes(NewSize - OldSize), ThreadSlot.IsExclusive);
+  else
+    AllocStatsAdd(&Slot->FreedBytes, ToBytes(OldSize - NewSize), ThreadSlot.IsExclusive);
+
+  AllocStatsAddLiveBytes(Stats, Slot, Convert<int64>(ToBytes(NewSize)) - Convert<int64>(ToBytes(OldSize)), ThreadSlot.IsExclusive);
+}
+
+auto
+::AllocStatsRecordCommit(allocation_stats* Stats, virtual_mem_page_mode PageMode, memory_size Size)
+  -> void
+{
+  if(Stats == nullptr)
+    return;
+
+  Assert(PageMode < VirtualMem_NumPageModes);
+  Stats->CommittedBytes[PageMode].fetch_add(Convert<int64>(ToBytes(Size)), std::memory_order_relaxed);
+}
+
+auto
+::AllocStatsRecordDecommit(allocation_stats* Stats, virtual_mem_page_mode PageMode, memory_size Size)
+  -> void
+{
+  if(Stats == nullptr)
+    return;
+
+  Assert(PageMode < VirtualMem_NumPageModes);
+  Stats->CommittedBytes[PageMode].fetch_sub(Convert<int64>(ToBytes(Size)), std::memory_order_relaxed);
+}
+
+auto
+::AllocStatsSnapshot(allocation_stats const& Stats)
+  -> allocation_stats_snapshot
+{
+  allocation_stats_snapshot Result{};
+  uint64 AllocatedBytes = 0;
+  uint64 FreedBytes = 0;
+  int64 PendingPeakBytes = 0;
+
+  for(auto& PaddedSlot : Stats.Slots)
+  {
+    auto& Slot = PaddedSlot.Value;
+    Result.NumAllocations += Slot.NumAllocations.load(std::memory_order_relaxed);
+    Result.NumFrees += Slot.NumFrees.load(std::memory_order_relaxed);
+    AllocatedBytes += Slot.AllocatedBytes.load(std::memory_order_relaxed);
+    FreedBytes += Slot.FreedBytes.load(std::memory_order_relaxed);
+    PendingPeakBytes += Slot.PendingPeakBytes.load(std::memory_order_relaxed);
+    for(size_t Bucket = 0; Bucket < AllocStats_NumHistogramBuckets; ++Bucket)
+      Result.SizeHistogram[Bucket] += Slot.SizeHistogram[Bucket].load(std::memory_order_relaxed);
+  }
+
+  // Frees may be recorded for memory that was allocated before recording
+  // started, so don't let the live size underflow.
+  auto const LiveBytes = AllocatedBytes > FreedBytes ? AllocatedBytes - FreedBytes : 0;
+
+  // Account for what the slots reached since they were last folded.
+  auto const PendingPeak = Stats.LiveBytes.load(std::memory_order_relaxed) + PendingPeakBytes;
+  auto const PeakBytes = Max(Max(Stats.PeakBytes.load(std::memory_order_relaxed), PendingPeak), int64(0));
+
+  Result.LiveSize = Bytes(LiveBytes);
+  Result.PeakSize = Bytes(Max(Convert<uint64>(PeakBytes), LiveBytes));
+  Result.TotalAllocatedSize = Bytes(AllocatedBytes);
+
+  for(size_t PageMode = 0; PageMode < VirtualMem_NumPageModes; ++PageMode)
+    Result.CommittedSize[PageMode] = Bytes(Convert<uint64>(Max(Stats.CommittedBytes[PageMode].load(std::memory_order_relaxed), int64(0))));
+
+  return Result;
+}
+
+auto
+::AllocStatsHistogramBucket(memory_size Size)
+  -> size_t
+{
+  auto const NumBytes = ToBytes(Size);
+  size_t Bucket = 0;
+  while(Bucket < AllocStats_NumHistogramBuckets - 1 && NumBytes > (uint64(16) << Bucket))
+    ++Bucket;
+
+  return Bucket;
+}
+
+auto
+::AllocStatsHistogramBucketLimit(size_t Bucket)
+  -> memory_size
+{
+  Assert(Bucket < AllocStats_NumHistogramBuckets);
+  return Bytes(uint64(16) << Bucket);
+}
+
+//]]~~
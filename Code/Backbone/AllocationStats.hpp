@@ -0,0 +1,165 @@
+#pragma once
+
+#include "Common.hpp"
+#include "VirtualMemory.hpp"
+
+#include <atomic>
+
+//~~[[
+
+RESERVE_PREFIX(AllocStats);
+
+enum
+{
+  /// Bucket N of the size histogram counts allocations of up to 16 << N
+  /// bytes. The last bucket counts everything bigger than that as well.
+  AllocStats_NumHistogramBuckets = 16,
+
+  /// The number of sets of counters threads record into.
+  AllocStats_NumThreadSlots = 16,
+
+  /// How far the live size of a single thread slot may drift before it is
+  /// folded into the shared live size, which is when the peak is updated.
+  AllocStats_PeakGranularity = 64 * 1024,
+};
+
+/// One set of counters, owned by the threads that map to it.
+struct impl_alloc_stats_slot
+{
+  std::atomic<uint64> NumAllocations;
+  std::atomic<uint64> NumFrees;
+  std::atomic<uint64> AllocatedBytes;
+  std::atomic<uint64> FreedBytes;
+
+  /// Live bytes not yet folded into allocation_stats::LiveBytes.
+  std::atomic<int64> PendingBytes;
+
+  /// The highest value PendingBytes reached since it was last folded.
+  std::atomic<int64> PendingPeakBytes;
+
+  std::atomic<uint64> SizeHistogram[AllocStats_NumHistogramBuckets];
+};
+
+/// Counters an allocator records its activity in.
+///
+/// Every Backbone allocator has a \c Stats member that is \c nullptr by
+/// default. Point it to an allocation_stats object to start recording. Each
+/// subsystem can use its own object, or several allocators can share one.
+///
+/// Recording is thread-safe and cheap: each thread only touches the counters
+/// of its own slot, so there is no contention on a shared cache line and no
+/// need for atomic read-modify-write operations. Only when more threads than
+/// slots are recording, the excess threads share the last slot.
+/// AllocStatsSnapshot merges all slots on read.
+///
+/// Usage:
+/// \code
+/// allocation_stats Stats;
+/// AllocStatsInit(&Stats);
+///
+/// arena Arena;
+/// ArenaInit(&Arena, MiB(1));
+/// Arena.Stats = &Stats;
+/// /* ... */
+/// auto Snapshot = AllocStatsSnapshot(Stats);
+/// \endcode
+struct allocation_stats
+{
+  cache_line_padded<impl_alloc_stats_slot> Slots[AllocStats_NumThreadSlots];
+
+  /// Sum of all folded PendingBytes of the slots.
+  std::atomic<int64> LiveBytes;
+
+  std::atomic<int64> PeakBytes;
+
+  /// Committed bytes of virtual memory, per page mode. Changes rarely, so
+  /// these are not per thread.
+  std::atomic<int64> CommittedBytes[VirtualMem_NumPageModes];
+};
+
+/// The merged counters of an allocation_stats object at one point in time.
+struct allocation_stats_snapshot
+{
+  /// The amount of memory currently allocated.
+  memory_size LiveSize;
+
+  /// The highest LiveSize ever observed.
+  ///
+  /// With several threads recording at the same time, this may be off by up
+  /// to AllocStats_PeakGranularity per thread.
+  memory_size PeakSize;
+
+  /// The amount of memory allocated over the whole lifetime.
+  memory_size TotalAllocatedSize;
+
+  uint64 NumAllocations;
+  uint64 NumFrees;
+
+  /// \see AllocStatsHistogramBucket
+  uint64 SizeHistogram[AllocStats_NumHistogramBuckets];
+
+  /// The amount of virtual memory currently committed, indexed by the
+  /// virtual_mem_page_mode that backs it. Shows whether huge pages were
+  /// actually used.
+  memory_size CommittedSize[VirtualMem_NumPageModes];
+};
+
+/// Reset all counters to zero.
+///
+/// Must not be called while other threads record into Stats.
+void
+AllocStatsInit(allocation_stats* Stats);
+
+/// Record an allocation of the given Size.
+///
+/// \param Stats May be \c nullptr, in which case nothing is recorded.
+void
+AllocStatsRecordAllocation(allocation_stats* Stats, memory_size Size);
+
+/// Record that the given amount of memory was freed.
+///
+/// Allocators that release many allocations at once, like an arena reset,
+/// record that as a single free of the accumulated size.
+///
+/// \param Stats May be \c nullptr, in which case nothing is recorded.
+void
+AllocStatsRecordFree(allocation_stats* Stats, memory_size Size);
+
+/// Record that an allocation was resized in place from OldSize to NewSize.
+///
+/// Only affects the live size, not the number of allocations or frees.
+///
+/// \param Stats May be \c nullptr, in which case nothing is recorded.
+void
+AllocStatsRecordResize(allocation_stats* Stats, memory_size OldSize, memory_size NewSize);
+
+/// Record that Size bytes of virtual memory backed by PageMode were
+/// committed.
+///
+/// \param Stats May be \c nullptr, in which case nothing is recorded.
+void
+AllocStatsRecordCommit(allocation_stats* Stats, virtual_mem_page_mode PageMode, memory_size Size);
+
+/// Record that Size bytes of virtual memory backed by PageMode were
+/// decommitted or released.
+///
+/// \param Stats May be \c nullptr, in which case nothing is recorded.
+void
+AllocStatsRecordDecommit(allocation_stats* Stats, virtual_mem_page_mode PageMode, memory_size Size);
+
+/// Merge the counters of all threads.
+allocation_stats_snapshot
+AllocStatsSnapshot(allocation_stats const& Stats);
+
+/// The index of the histogram bucket allocations of the given Size are
+/// counted in.
+size_t
+AllocStatsHistogramBucket(memory_size Size);
+
+/// The biggest allocation size that is counted in the given bucket.
+///
+/// The last bucket counts bigger allocations as well.
+memory_size
+AllocStatsHistogramBucketLimit(size_t Bucket);
+
+//]]~~
@@ -0,0 +1,45 @@
+#include "Allocator.hpp"
+
+//~~[[
+
+auto
+::AllocatorAllocateBytes(allocator Allocator, memory_size Size, size_t Alignment)
+  -> void*
+{
+  Assert(Allocator.AllocateFunc);
+  Assert(IsPowerOfTwo(Alignment));
+  return Allocator.AllocateFunc(Allocator.Context, Size, Alignment);
+}
+
+auto
+::AllocatorReallocateBytes(allocator Allocator, void* Ptr, memory_size OldSize, memory_size NewSize, size_t Alignment)
+  -> void*
+{
+  Assert(IsPowerOfTwo(Alignment));
+
+  if(Ptr == nullptr)
+    return AllocatorAllocateBytes(Allocator, NewSize, Alignment);
+
+  if(Allocator.ReallocateFunc)
+    return Allocator.ReallocateFunc(Allocator.Context, Ptr, OldSize, NewSize, Alignment);
+
+  auto NewPtr = AllocatorAllocateBytes(Allocator, NewSize, Alignment);
+  if(NewPtr == nullptr)
+    return nullptr;
+
+  MemCopyBytes(Min(OldSize, NewSize), NewPtr, Ptr);
+  AllocatorFreeBytes(Allocator, Ptr, OldSize);
+  return NewPtr;
+}
+
+auto
+::AllocatorFreeBytes(allocator Allocator, void* Ptr, memory_size Size)
+  -> void
+{
+  if(Ptr == nullptr || Allocator.FreeFunc == nullptr)
+    return;
+
+  Allocator.FreeFunc(Allocator.Context, Ptr, Size);
+}
+
+//]]~~
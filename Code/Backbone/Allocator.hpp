@@ -0,0 +1,166 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Memory.hpp"
+#include "Slice.hpp"
+
+//~~[[
+
+RESERVE_PREFIX(Allocator);
+
+using allocator_allocate_func   = void* (void* Context, memory_size Size, size_t Alignment);
+using allocator_reallocate_func = void* (void* Context, void* Ptr, memory_size OldSize, memory_size NewSize, size_t Alignment);
+using allocator_free_func       = void  (void* Context, void* Ptr, memory_size Size);
+
+/// A type-erased allocator.
+///
+/// Functions that need to allocate memory can take an allocator instead of a
+/// concrete allocator type, so the caller may choose between an arena, a
+/// stack, a pool, or the heap per call site. An allocator is just a context
+/// pointer plus a table of functions and is meant to be passed by value.
+///
+/// Each Backbone allocator provides an overload of AllocatorFrom that
+/// returns an allocator referring to it. DefaultAllocator returns the
+/// process-wide heap.
+///
+/// Usage:
+/// \code
+/// arena Arena;
+/// /* ... */
+/// auto Buffer = AllocatorAllocate<char>(AllocatorFrom(&Arena), 256);
+/// \endcode
+struct allocator
+{
+  /// Passed as the first argument to all functions.
+  void* Context;
+
+  allocator_allocate_func* AllocateFunc;
+
+  /// May be \c nullptr, in which case reallocating is done by allocating
+  /// new memory, copying, and freeing the old memory.
+  allocator_reallocate_func* ReallocateFunc;
+
+  /// May be \c nullptr if the allocator can't free individual allocations.
+  allocator_free_func* FreeFunc;
+};
+
+/// Allocate Size bytes with the given Alignment.
+///
+/// \param Alignment Must be a power of two.
+/// \return \c nullptr if out of memory.
+void*
+AllocatorAllocateBytes(allocator Allocator, memory_size Size, size_t Alignment);
+
+/// Resize the allocation at Ptr from OldSize to NewSize bytes.
+///
+/// The contents up to the smaller of both sizes are preserved. The result
+/// may or may not be the same as Ptr.
+///
+/// \param Ptr May be \c nullptr, in which case this is an allocation.
+/// \return \c nullptr if out of memory, in which case Ptr is still valid.
+void*
+AllocatorReallocateBytes(allocator Allocator, void* Ptr, memory_size OldSize, memory_size NewSize, size_t Alignment);
+
+/// Free memory previously allocated with the same Allocator.
+///
+/// \param Size Must be the size that was used to allocate Ptr.
+void
+AllocatorFreeBytes(allocator Allocator, void* Ptr, memory_size Size);
+
+/// Allocate Num elements of type T with the first element aligned to at
+/// least Alignment bytes, and construct them with Args.
+///
+/// Useful to get memory for SIMD kernels or memory that must not share a
+/// cache line with anything else.
+///
+/// \param Alignment Must be a power of two. If it is less than alignof(T),
+///                  alignof(T) is used instead.
+/// \see MemConstruct
+/// \return An empty slice if out of memory.
+template<typename T, typename... ArgTypes>
+slice<T>
+AllocatorAllocateAligned(allocator Allocator, size_t Num, size_t Alignment, ArgTypes&&... Args)
+{
+  auto Ptr = Reinterpret<T*>(AllocatorAllocateBytes(Allocator, Num * SizeOf<T>(), Max(Alignment, alignof(T))));
+  if(Ptr == nullptr)
+    return {};
+
+  MemConstruct(Num, Ptr, Forward<ArgTypes>(Args)...);
+  return Slice(Num, Ptr);
+}
+
+/// Allocate Num elements of type T and construct them with Args.
+///
+/// \see MemConstruct
+/// \return An empty slice if out of memory.
+template<typename T, typename... ArgTypes>
+slice<T>
+AllocatorAllocate(allocator Allocator, size_t Num, ArgTypes&&... Args)
+{
+  return AllocatorAllocateAligned<T>(Allocator, Num, alignof(T), Forward<ArgTypes>(Args)...);
+}
+
+/// Destruct all elements of Elements and free its memory.
+///
+/// \see MemDestruct
+template<typename T>
+void
+AllocatorFree(allocator Allocator, slice<T> Elements)
+{
+  MemDestruct(Elements.Num, Elements.Ptr);
+  AllocatorFreeBytes(Allocator, Elements.Ptr, Elements.Num * SizeOf<T>());
+}
+
+template<typename T, bool TIsTriviallyRelocatable = false>
+struct impl_allocator_relocate
+{
+  static T*
+  Do(allocator Allocator, slice<T> Elements, size_t NewNum)
+  {
+    // These types can't be relocated by copying bytes around.
+    auto NewPtr = Reinterpret<T*>(AllocatorAllocateBytes(Allocator, NewNum * SizeOf<T>(), alignof(T)));
+    if(NewPtr == nullptr)
+      return nullptr;
+
+    MemMoveConstruct(Min(Elements.Num, NewNum), NewPtr, Elements.Ptr);
+    AllocatorFreeBytes(Allocator, Elements.Ptr, Elements.Num * SizeOf<T>());
+    return NewPtr;
+  }
+};
+
+template<typename T>
+struct impl_allocator_relocate<T, true>
+{
+  static T*
+  Do(allocator Allocator, slice<T> Elements, size_t NewNum)
+  {
+    return Reinterpret<T*>(AllocatorReallocateBytes(Allocator, Elements.Ptr, Elements.Num * SizeOf<T>(), NewNum * SizeOf<T>(), alignof(T)));
+  }
+};
+
+/// Resize Elements to NewNum elements.
+///
+/// Existing elements are moved over if the memory had to be relocated. New
+/// elements are default-constructed, superfluous elements are destructed.
+///
+/// \return An empty slice if out of memory, in which case the elements
+///         beyond NewNum are already destructed but Elements is otherwise
+///         still valid.
+template<typename T>
+slice<T>
+AllocatorReallocate(allocator Allocator, slice<T> Elements, size_t NewNum)
+{
+  if(NewNum < Elements.Num)
+    MemDestruct(Elements.Num - NewNum, MemAddOffset(Elements.Ptr, NewNum));
+
+  auto NewPtr = impl_allocator_relocate<T, IsTriviallyRelocatable<T>()>::Do(Allocator, Elements, NewNum);
+  if(NewPtr == nullptr)
+    return {};
+
+  if(NewNum > Elements.Num)
+    MemConstruct(NewNum - Elements.Num, MemAddOffset(NewPtr, Elements.Num));
+
+  return Slice(NewNum, NewPtr);
+}
+
+//]]~~
@@ -0,0 +1,230 @@
+#include "Arena.hpp"
+#include "VirtualMemory.hpp"
+
+#include <cstdlib>
+
+//~~[[
+
+/// Virtual memory arenas commit at least this much at once to keep the
+/// number of system calls low.
+static memory_size const ArenaMinCommitSize = KiB(64);
+
+auto
+::ArenaInit(arena* Arena, slice<void> Memory)
+  -> void
+{
+  Assert(Arena);
+  Arena->Memory = Memory;
+  Arena->Used = 0;
+  Arena->Committed = Memory.Num;
+  Arena->Backing = arena::ExternalMemory;
+  Arena->PageMode = VirtualMem_NormalPages;
+  Arena->Stats = nullptr;
+}
+
+auto
+::ArenaInit(arena* Arena, memory_size Capacity)
+  -> void
+{
+  Assert(Arena);
+  auto Ptr = std::malloc(ToBytes(Capacity));
+  Arena->Memory = Slice(Ptr ? Convert<size_t>(ToBytes(Capacity)) : 0, Ptr);
+  Arena->Used = 0;
+  Arena->Committed = Arena->Memory.Num;
+  Arena->Backing = arena::HeapMemory;
+  Arena->PageMode = VirtualMem_NormalPages;
+  Arena->Stats = nullptr;
+}
+
+/// The granularity with which a virtual memory arena commits memory.
+static size_t
+ArenaPageSize(virtual_mem_page_mode PageMode)
+{
+  auto const PageSize = PageMode == VirtualMem_NormalPages ? VirtualMemPageSize() : VirtualMemHugePageSize();
+  return Convert<size_t>(ToBytes(PageSize));
+}
+
+auto
+::ArenaInitVirtual(arena* Arena, memory_size ReserveSize, virtual_mem_page_mode PageMode)
+  -> void
+{
+  Assert(Arena);
+  auto const Size = AlignUp(Convert<size_t>(ToBytes(ReserveSize)), ArenaPageSize(PageMode));
+  auto Ptr = VirtualMemReserve(Bytes(Size), PageMode, &Arena->PageMode);
+  Arena->Memory = Slice(Ptr ? Size : 0, Ptr);
+  Arena->Used = 0;
+  Arena->Committed = 0;
+  Arena->Backing = arena::VirtualMemory;
+  Arena->Stats = nullptr;
+}
+
+auto
+::ArenaFinalize(arena* Arena)
+  -> void
+{
+  Assert(Arena);
+  if(Arena->Used > 0)
+    AllocStatsRecordFree(Arena->Stats, Bytes(Arena->Used));
+
+  if(Arena->Backing == arena::VirtualMemory && Arena->Committed > 0)
+    AllocStatsRecordDecommit(Arena->Stats, Arena->PageMode, Bytes(Arena->Committed));
+
+  switch(Arena->Backing)
+  {
+  case arena::HeapMemory:
+    std::free(Arena->Memory.Ptr);
+    break;
+  case arena::VirtualMemory:
+    if(Arena->Memory.Ptr)
+      VirtualMemRelease(Arena->Memory.Ptr, Bytes(Arena->Memory.Num));
+    break;
+  default:
+    break;
+  }
+
+  *Arena = {};
+}
+
+/// Commit enough pages of a virtual memory arena to make the first NewUsed
+/// bytes accessible.
+static bool
+ArenaGrow(arena* Arena, size_t NewUsed)
+{
+  if(Arena->Backing != arena::VirtualMemory)
+    return false;
+
+  auto const PageSize = ArenaPageSize(Arena->PageMode);
+  auto const CommitSize = Max(AlignUp(NewUsed - Arena->Committed, PageSize),
+                              Convert<size_t>(ToBytes(ArenaMinCommitSize)));
+  auto const NewCommitted = Min(Arena->Committed + CommitSize, Arena->Memory.Num);
+
+  auto const CommitBegin = MemAddByteOffset(Arena->Memory.Ptr, Arena->Committed);
+  if(!VirtualMemCommit(CommitBegin, Bytes(NewCommitted - Arena->Committed)))
+    return false;
+
+  AllocStatsRecordCommit(Arena->Stats, Arena->PageMode, Bytes(NewCommitted - Arena->Committed));
+  Arena->Committed = NewCommitted;
+  return true;
+}
+
+auto
+::ArenaAllocateBytes(arena* Arena, memory_size Size, size_t Alignment)
+  -> void*
+{
+  Assert(Arena);
+  Assert(IsPowerOfTwo(Alignment));
+
+  auto const Base = Reinterpret<size_t>(Arena->Memory.Ptr);
+  auto const Begin = AlignUp(Base + Arena->Used, Alignment);
+  auto const Offset = Begin - Base;
+
+  // Compare against the remaining space, Offset + Size may wrap around.
+  if(Offset > Arena->Memory.Num || ToBytes(Size) > Arena->Memory.Num - Offset)
+    return nullptr;
+
+  auto const NewUsed = Offset + Convert<size_t>(ToBytes(Size));
+
+  if(NewUsed > Arena->Committed && !ArenaGrow(Arena, NewUsed))
+    return nullptr;
+
+  // Alignment padding is accounted to the allocation.
+  AllocStatsRecordAllocation(Arena->Stats, Bytes(NewUsed - Arena->Used));
+  Arena->Used = NewUsed;
+  return Reinterpret<void*>(Begin);
+}
+
+auto
+::ArenaReset(arena* Arena)
+  -> void
+{
+  Assert(Arena);
+  if(Arena->Used > 0)
+    AllocStatsRecordFree(Arena->Stats, Bytes(Arena->Used));
+
+  Arena->Used = 0;
+}
+
+auto
+::ArenaDecommitUnused(arena* Arena)
+  -> void
+{
+  Assert(Arena);
+  // Explicit huge pages stay taken from the pool until the arena is
+  // finalized anyway.
+  if(Arena->Backing != arena::VirtualMemory || Arena->PageMode == VirtualMem_ExplicitHugePages)
+    return;
+
+  auto const PageSize = ArenaPageSize(Arena->PageMode);
+  auto const NewCommitted = AlignUp(Arena->Used, PageSize);
+  if(NewCommitted >= Arena->Committed)
+    return;
+
+  VirtualMemDecommit(MemAddByteOffset(Arena->Memory.Ptr, NewCommitted), Bytes(Arena->Committed - NewCommitted));
+  AllocStatsRecordDecommit(Arena->Stats, Arena->PageMode, Bytes(Arena->Committed - NewCommitted));
+  Arena->Committed = NewCommitted;
+}
+
+static void*
+ArenaAllocatorAllocate(void* Context, memory_size Size, size_t Alignment)
+{
+  return ArenaAllocateBytes(Reinterpret<arena*>(Context), Size, Alignment);
+}
+
+static void*
+ArenaAllocatorReallocate(void* Context, void* Ptr, memory_size OldSize, memory_size NewSize, size_t Alignment)
+{
+  auto Arena = Reinterpret<arena*>(Context);
+  auto const Offset = Reinterpret<size_t>(Ptr) - Reinterpret<size_t>(Arena->Memory.Ptr);
+  auto const IsMostRecent = Offset + ToBytes(OldSize) == Arena->Used;
+
+  if(IsMostRecent && IsAligned(Ptr, Alignment) && ToBytes(NewSize) <= Arena->Memory.Num - Offset)
+  {
+    auto const NewUsed = Offset + Convert<size_t>(ToBytes(NewSize));
+    if(NewUsed <= Arena->Committed || ArenaGrow(Arena, NewUsed))
+    {
+      AllocStatsRecordResize(Arena->Stats, Bytes(Arena->Used), Bytes(NewUsed));
+      Arena->Used = NewUsed;
+      return Ptr;
+    }
+  }
+
+  auto NewPtr = ArenaAllocateBytes(Arena, NewSize, Alignment);
+  if(NewPtr)
+    MemCopyBytes(Min(OldSize, NewSize), NewPtr, Ptr);
+  return NewPtr;
+}
+
+auto
+::AllocatorFrom(arena* Arena)
+  -> allocator
+{
+  allocator Result;
+  Result.Context = Arena;
+  Result.AllocateFunc = ArenaAllocatorAllocate;
+  Result.ReallocateFunc = ArenaAllocatorReallocate;
+  Result.FreeFunc = nullptr;
+  return Result;
+}
+
+auto
+::ArenaUsed(arena const& Arena)
+  -> memory_size
+{
+  return Bytes(Arena.Used);
+}
+
+auto
+::ArenaCapacity(arena const& Arena)
+  -> memory_size
+{
+  return Bytes(Arena.Memory.Num);
+}
+
+auto
+::ArenaCommitted(arena const& Arena)
+  -> memory_size
+{
+  return Bytes(Arena.Committed);
+}
+
+//]]~~
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Memory.hpp"
+#include "Slice.hpp"
+#include "Allocator.hpp"
+#include "AllocationStats.hpp"
+#include "VirtualMemory.hpp"
+
+//~~[[
+
+RESERVE_PREFIX(Arena);
+
+/// A linear (bump) allocator.
+///
+/// Memory is handed out front to back from a single contiguous block.
+/// Individual allocations cannot be freed. Instead, the whole arena is reset
+/// at once, which is an O(1) operation.
+///
+/// Usage:
+/// \code
+/// arena Arena;
+/// ArenaInit(&Arena, KiB(64));
+/// Defer [&](){ ArenaFinalize(&Arena); };
+///
+/// slice<int> Ints = ArenaAllocate<int>(&Arena, 128);
+/// /* ... */
+/// ArenaReset(&Arena); // Ints is no longer valid.
+/// \endcode
+///
+/// \see ArenaInitVirtual for an arena that grows without ever moving.
+struct arena
+{
+  /// Where the memory of an arena comes from.
+  enum backing
+  {
+    /// Memory was provided by the user.
+    ExternalMemory,
+
+    /// Memory was allocated from the heap by the arena itself.
+    HeapMemory,
+
+    /// Memory is a reserved range of address space that is committed on
+    /// demand.
+    VirtualMemory,
+  };
+
+  /// The memory this arena hands out.
+  slice<void> Memory;
+
+  /// Number of bytes already in use, counted from the front of Memory.
+  size_t Used;
+
+  /// Number of bytes at the front of Memory that are accessible.
+  ///
+  /// Only virtual memory arenas have Committed < Memory.Num.
+  size_t Committed;
+
+  backing Backing;
+
+  /// What kind of pages back a virtual memory arena.
+  virtual_mem_page_mode PageMode;
+
+  /// Where to record allocations. May be \c nullptr.
+  ///
+  /// \see allocation_stats
+  allocation_stats* Stats;
+};
+
+/// Initialize the arena to hand out memory from the given buffer.
+///
+/// The arena does not take ownership of Memory.
+void
+ArenaInit(arena* Arena, slice<void> Memory);
+
+/// Initialize the arena with a buffer of the given capacity allocated from
+/// the heap. That buffer is freed again in ArenaFinalize.
+void
+ArenaInit(arena* Arena, memory_size Capacity);
+
+/// Initialize the arena with a reserved range of virtual address space.
+///
+/// Nothing is committed up front. Pages are committed as the arena grows, so
+/// reserving a huge range such as GiB(64) is cheap. Since the range never
+/// moves, pointers handed out by the arena stay valid and growing never
+/// copies anything.
+///
+/// With huge pages, the reservation is rounded up to and memory is
+/// committed in multiples of VirtualMemHugePageSize(), which cuts down on
+/// TLB misses for big arenas. If the requested PageMode is not available,
+/// the arena silently falls back to normal pages. The mode in use is stored
+/// in arena::PageMode and recorded in the arena's Stats.
+///
+/// \see VirtualMemReserve
+void
+ArenaInitVirtual(arena* Arena, memory_size ReserveSize, virtual_mem_page_mode PageMode = VirtualMem_NormalPages);
+
+/// Release the memory owned by the arena, if any, and reset it to an
+/// uninitialized state.
+void
+ArenaFinalize(arena* Arena);
+
+/// Allocate Size bytes with the given Alignment.
+///
+/// \param Alignment Must be a power of two.
+/// \return \c nullptr if the arena has not enough memory left.
+void*
+ArenaAllocateBytes(arena* Arena, memory_size Size, size_t Alignment);
+
+/// Make all memory of the arena available again.
+///
+/// No destructors are called, all previously allocated memory is simply
+/// considered unused afterwards.
+void
+ArenaReset(arena* Arena);
+
+/// Give committed but unused pages of a virtual memory arena back to the OS.
+///
+/// Does nothing for other arenas and for arenas backed by explicit huge
+/// pages.
+void
+ArenaDecommitUnused(arena* Arena);
+
+/// The number of bytes currently in use, including alignment padding.
+memory_size
+ArenaUsed(arena const& Arena);
+
+/// The total amount of memory the arena manages.
+memory_size
+ArenaCapacity(arena const& Arena);
+
+/// The amount of memory that is backed by physical memory.
+///
+/// Same as ArenaCapacity, except for virtual memory arenas.
+memory_size
+ArenaCommitted(arena const& Arena);
+
+/// Get an allocator that allocates from the given arena.
+///
+/// Freeing through that allocator does nothing. Reallocating the most recent
+/// allocation grows or shrinks it in place if possible.
+allocator
+AllocatorFrom(arena* Arena);
+
+/// Allocate Num elements of type T and construct them with Args.
+///
+/// \see MemConstruct
+/// \return An empty slice if the arena has not enough memory left.
+template<typename T, typename... ArgTypes>
+slice<T>
+ArenaAllocate(arena* Arena, size_t Num, ArgTypes&&... Args)
+{
+  if(Num > IntMaxValue<size_t>() / sizeof(T))
+    return {};
+
+  auto Ptr = Reinterpret<T*>(ArenaAllocateBytes(Arena, Num * SizeOf<T>(), alignof(T)));
+  if(Ptr == nullptr)
+    return {};
+
+  MemConstruct(Num, Ptr, Forward<ArgTypes>(Args)...);
+  return Slice(Num, Ptr);
+}
+
+//]]~~
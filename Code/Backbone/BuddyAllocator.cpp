@@ -0,0 +1,308 @@
+#include "BuddyAllocator.hpp"
+#include "Heap.hpp"
+
+//~~[[
+
+static size_t
+BuddyOrderSize(buddy_allocator const& Buddy, uint32 Order)
+{
+  Assert(Order > 0);
+  return Buddy.MinBlockSize << (Order - 1);
+}
+
+static bool
+BuddyIsAllocated(buddy_allocator const& Buddy, size_t Node)
+{
+  return IsBitSet(Buddy.AllocatedBits[Node / 64], uint64(Node % 64));
+}
+
+static void
+BuddySetAllocated(buddy_allocator* Buddy, size_t Node, bool IsAllocated)
+{
+  auto& Bits = Buddy->AllocatedBits[Node / 64];
+  Bits = IsAllocated ? SetBit(Bits, uint64(Node % 64)) : UnsetBit(Bits, uint64(Node % 64));
+}
+
+/// Recompute the tree entry of the given Node of the given Order from its
+/// children. Two entirely free children merge into an entirely free parent.
+static void
+BuddyUpdateNode(buddy_allocator* Buddy, size_t Node, uint32 Order)
+{
+  auto const Left = Buddy->Tree[2 * Node];
+  auto const Right = Buddy->Tree[2 * Node + 1];
+  auto const ChildOrder = Convert<uint8>(Order - 1);
+  if(Left == ChildOrder && Right == ChildOrder)
+    Buddy->Tree[Node] = Convert<uint8>(Order);
+  else
+    Buddy->Tree[Node] = Max(Left, Right);
+}
+
+/// Update all ancestors of Node after its entry changed.
+static void
+BuddyUpdateAncestors(buddy_allocator* Buddy, size_t Node, uint32 Order)
+{
+  while(Node > 1)
+  {
+    Node /= 2;
+    ++Order;
+    BuddyUpdateNode(Buddy, Node, Order);
+  }
+}
+
+/// Find the node that was allocated for Ptr.
+///
+/// Starts at the leaf for Ptr and walks up as long as Ptr is the beginning of
+/// the current node.
+///
+/// \return INVALID_INDEX if Ptr was not allocated from this buddy allocator,
+///         or was already freed.
+static size_t
+BuddyFindAllocatedNode(buddy_allocator const& Buddy, void* Ptr, uint32* Out_Order)
+{
+  if(Buddy.NumLevels == 0)
+    return INVALID_INDEX;
+
+  auto const Offset = Reinterpret<size_t>(Ptr) - Reinterpret<size_t>(Buddy.Memory.Ptr);
+  if(Offset >= Buddy.Memory.Num || !IsAligned(Offset, Buddy.MinBlockSize))
+    return INVALID_INDEX;
+
+  auto const NumLeaves = size_t(1) << (Buddy.NumLevels - 1);
+  auto Node = NumLeaves + Offset / Buddy.MinBlockSize;
+  uint32 Order = 1;
+  while(!BuddyIsAllocated(Buddy, Node))
+  {
+    // Reached the root, or Ptr is not the beginning of the parent node.
+    if(Node == 1 || Node % 2 != 0)
+      return INVALID_INDEX;
+
+    Node /= 2;
+    ++Order;
+  }
+
+  *Out_Order = Order;
+  return Node;
+}
+
+auto
+::BuddyInit(buddy_allocator* Buddy, slice<void> Memory, memory_size MinBlockSize)
+  -> bool
+{
+  Assert(Buddy);
+  auto const BlockSize = Convert<size_t>(ToBytes(MinBlockSize));
+  Assert(IsPowerOfTwo(BlockSize));
+
+  *Buddy = {};
+  Buddy->MinBlockSize = BlockSize;
+
+  auto const Begin = AlignUp(Reinterpret<size_t>(Memory.Ptr), BlockSize);
+  auto const End = Reinterpret<size_t>(Memory.Ptr) + Memory.Num;
+  auto const NumBlocks = Begin < End ? (End - Begin) / BlockSize : 0;
+  if(NumBlocks == 0)
+    return false;
+
+  // The tree is complete, so it has a power of two of leaves. Leaves beyond
+  // NumBlocks are never free.
+  size_t NumLeaves = 1;
+  uint32 NumLevels = 1;
+  while(NumLeaves < NumBlocks)
+  {
+    NumLeaves *= 2;
+    ++NumLevels;
+  }
+
+  auto const NumNodes = 2 * NumLeaves;
+  auto const NumBitWords = (NumNodes + 63) / 64;
+  auto const TreeOffset = NumBitWords * sizeof(uint64);
+  auto Bookkeeping = MemAllocate(Bytes(TreeOffset + NumNodes), alignof(uint64));
+  if(Bookkeeping == nullptr)
+    return false;
+
+  Buddy->Memory = Slice(NumBlocks * BlockSize, Reinterpret<void*>(Begin));
+  Buddy->NumLevels = NumLevels;
+  Buddy->AllocatedBits = Slice(NumBitWords, Reinterpret<uint64*>(Bookkeeping));
+  Buddy->Tree = Slice(NumNodes, Reinterpret<uint8*>(MemAddByteOffset(Bookkeeping, TreeOffset)));
+
+  MemSet(Buddy->AllocatedBits.Num, Buddy->AllocatedBits.Ptr, uint64(0));
+  Buddy->Tree[0] = 0;
+  for(size_t Leaf = 0; Leaf < NumLeaves; ++Leaf)
+    Buddy->Tree[NumLeaves + Leaf] = Leaf < NumBlocks ? 1 : 0;
+
+  // Build the remaining levels bottom up.
+  for(uint32 Order = 2; Order <= NumLevels; ++Order)
+  {
+    auto const First = NumLeaves >> (Order - 1);
+    for(size_t Node = First; Node < 2 * First; ++Node)
+      BuddyUpdateNode(Buddy, Node, Order);
+  }
+
+  return true;
+}
+
+auto
+::BuddyFinalize(buddy_allocator* Buddy)
+  -> void
+{
+  Assert(Buddy);
+  if(Buddy->UsedBytes)
+    AllocStatsRecordFree(Buddy->Stats, Bytes(Buddy->UsedBytes));
+
+  MemFree(Buddy->AllocatedBits.Ptr);
+  *Buddy = {};
+}
+
+auto
+::BuddyAllocateBytes(buddy_allocator* Buddy, memory_size Size, size_t Alignment)
+  -> void*
+{
+  Assert(Buddy);
+  Assert(IsPowerOfTwo(Alignment));
+
+  if(Buddy->NumLevels == 0)
+    return nullptr;
+
+  // Every block is aligned to its size relative to the beginning of Memory,
+  // but not to more than Memory itself is aligned to.
+  auto const Base = Reinterpret<size_t>(Buddy->Memory.Ptr);
+  auto const BaseAlignment = Base & (~Base + 1);
+  if(Alignment > BaseAlignment)
+    return nullptr;
+
+  auto const NeededSize = Max(ToBytes(Size), uint64(Alignment));
+  uint32 Order = 1;
+  while(Order <= Buddy->NumLevels && BuddyOrderSize(*Buddy, Order) < NeededSize)
+    ++Order;
+
+  if(Buddy->Tree[1] < Order)
+    return nullptr;
+
+  // Descend to a free node of the wanted order. Of two children that both
+  // fit, take the one with the smaller free block to keep big blocks intact.
+  size_t Node = 1;
+  for(auto NodeOrder = Buddy->NumLevels; NodeOrder > Order; --NodeOrder)
+  {
+    auto const Left = Buddy->Tree[2 * Node];
+    auto const Right = Buddy->Tree[2 * Node + 1];
+    if(Left >= Order && (Right < Order || Left <= Right))
+      Node = 2 * Node;
+    else
+      Node = 2 * Node + 1;
+  }
+
+  Buddy->Tree[Node] = 0;
+  BuddySetAllocated(Buddy, Node, true);
+  BuddyUpdateAncestors(Buddy, Node, Order);
+
+  auto const BlockSize = BuddyOrderSize(*Buddy, Order);
+  auto const FirstNodeOfLevel = size_t(1) << (Buddy->NumLevels - Order);
+  auto const Offset = (Node - FirstNodeOfLevel) * BlockSize;
+
+  Buddy->UsedBytes += BlockSize;
+  AllocStatsRecordAllocation(Buddy->Stats, Bytes(BlockSize));
+  return MemAddByteOffset(Buddy->Memory.Ptr, Offset);
+}
+
+auto
+::BuddyFree(buddy_allocator* Buddy, void* Ptr)
+  -> void
+{
+  Assert(Buddy);
+  if(Ptr == nullptr)
+    return;
+
+  uint32 Order;
+  auto const Node = BuddyFindAllocatedNode(*Buddy, Ptr, &Order);
+  if(Node == INVALID_INDEX)
+    return;
+
+  BuddySetAllocated(Buddy, Node, false);
+  Buddy->Tree[Node] = Convert<uint8>(Order);
+  BuddyUpdateAncestors(Buddy, Node, Order);
+
+  auto const BlockSize = BuddyOrderSize(*Buddy, Order);
+  Buddy->UsedBytes -= BlockSize;
+  AllocStatsRecordFree(Buddy->Stats, Bytes(BlockSize));
+}
+
+auto
+::BuddyBlockSize(buddy_allocator const& Buddy, void* Ptr)
+  -> memory_size
+{
+  uint32 Order;
+  if(BuddyFindAllocatedNode(Buddy, Ptr, &Order) == INVALID_INDEX)
+    return Bytes(0);
+
+  return Bytes(BuddyOrderSize(Buddy, Order));
+}
+
+auto
+::BuddyUsed(buddy_allocator const& Buddy)
+  -> memory_size
+{
+  return Bytes(Buddy.UsedBytes);
+}
+
+auto
+::BuddyCapacity(buddy_allocator const& Buddy)
+  -> memory_size
+{
+  return Bytes(Buddy.Memory.Num);
+}
+
+auto
+::BuddyLargestFreeBlock(buddy_allocator const& Buddy)
+  -> memory_size
+{
+  if(Buddy.NumLevels == 0 || Buddy.Tree[1] == 0)
+    return Bytes(0);
+
+  return Bytes(BuddyOrderSize(Buddy, Buddy.Tree[1]));
+}
+
+auto
+::BuddyFragmentation(buddy_allocator const& Buddy)
+  -> memory_size
+{
+  return BuddyCapacity(Buddy) - BuddyUsed(Buddy) - BuddyLargestFreeBlock(Buddy);
+}
+
+static void*
+BuddyAllocatorAllocate(void* Context, memory_size Size, size_t Alignment)
+{
+  return BuddyAllocateBytes(Reinterpret<buddy_allocator*>(Context), Size, Alignment);
+}
+
+static void*
+BuddyAllocatorReallocate(void* Context, void* Ptr, memory_size OldSize, memory_size NewSize, size_t Alignment)
+{
+  auto Buddy = Reinterpret<buddy_allocator*>(Context);
+  if(NewSize <= BuddyBlockSize(*Buddy, Ptr) && IsAligned(Ptr, Alignment))
+    return Ptr;
+
+  auto NewPtr = BuddyAllocateBytes(Buddy, NewSize, Alignment);
+  if(NewPtr)
+  {
+    MemCopyBytes(Min(OldSize, NewSize), NewPtr, Ptr);
+    BuddyFree(Buddy, Ptr);
+  }
+  return NewPtr;
+}
+
+static void
+BuddyAllocatorFree(void* Context, void* Ptr, memory_size Size)
+{
+  BuddyFree(Reinterpret<buddy_allocator*>(Context), Ptr);
+}
+
+auto
+::AllocatorFrom(buddy_allocator* Buddy)
+  -> allocator
+{
+  allocator Result;
+  Result.Context = Buddy;
+  Result.AllocateFunc = BuddyAllocatorAllocate;
+  Result.ReallocateFunc = BuddyAllocatorReallocate;
+  Result.FreeFunc = BuddyAllocatorFree;
+  return Result;
+}
+
+//]]~~
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Memory.hpp"
+#include "Slice.hpp"
+#include "Allocator.hpp"
+#include "AllocationStats.hpp"
+
+//~~[[
+
+RESERVE_PREFIX(Buddy);
+
+/// A power-of-two block allocator over a single region of memory.
+///
+/// The region is divided into blocks of MinBlockSize. Every allocation gets
+/// the smallest block of MinBlockSize * 2^N bytes it fits into. A free
+/// block is split in halves ("buddies") until it has the right size, and
+/// when both halves of a block are free again they are merged back.
+///
+/// Unlike an arena, every allocation can be freed individually and in any
+/// order, at the cost of rounding sizes up to a power of two.
+///
+/// The bookkeeping is kept out of the managed memory, so the region is never
+/// read or written by the allocator itself. For every node of the binary
+/// tree of blocks, Tree stores the order of the largest free block within
+/// that node, and AllocatedBits marks the nodes that were handed out.
+/// Allocating and freeing walk a single path through that tree, which takes
+/// O(log n) steps.
+///
+/// Not thread-safe.
+struct buddy_allocator
+{
+  /// The managed memory, aligned to and a multiple of MinBlockSize.
+  slice<void> Memory;
+
+  /// The size of the smallest blocks. A power of two.
+  size_t MinBlockSize;
+
+  /// The number of tree levels, i.e. the order of the root. A block of order
+  /// N is MinBlockSize * 2^(N - 1) bytes big. Order 0 means "nothing".
+  uint32 NumLevels;
+
+  /// One entry per tree node, indexed from 1 with the children of node N at
+  /// 2N and 2N + 1. Holds the order of the largest free block within the
+  /// node, which equals the order of the node itself if it is entirely free.
+  slice<uint8> Tree;
+
+  /// One bit per tree node. Set for nodes that are allocated as a whole.
+  slice<uint64> AllocatedBits;
+
+  /// The size of all blocks currently handed out.
+  size_t UsedBytes;
+
+  /// Where to record allocations. May be \c nullptr.
+  ///
+  /// \see allocation_stats
+  allocation_stats* Stats;
+};
+
+/// Initialize the buddy allocator to hand out memory from the given region.
+///
+/// The allocator does not take ownership of Memory. The beginning of Memory
+/// is skipped up to the first multiple of MinBlockSize, and any remainder at
+/// the end that is smaller than MinBlockSize is not used.
+///
+/// The tree is allocated with MemAllocate.
+///
+/// \param MinBlockSize Must be a power of two.
+/// \return \c false if Memory doesn't hold a single block, or if the tree
+///         could not be allocated. The allocator is left empty then and hands
+///         out nothing, but BuddyFinalize may still be called on it.
+bool
+BuddyInit(buddy_allocator* Buddy, slice<void> Memory, memory_size MinBlockSize = Bytes(64));
+
+/// Release the bookkeeping memory and reset the allocator to an
+/// uninitialized state.
+void
+BuddyFinalize(buddy_allocator* Buddy);
+
+/// Allocate a block of at least Size bytes with the given Alignment.
+///
+/// \param Alignment Must be a power of two. Blocks are aligned to their size,
+///                  so requests with a bigger alignment than Size get a
+///                  bigger block.
+/// \return \c nullptr if there is no free block big enough.
+void*
+BuddyAllocateBytes(buddy_allocator* Buddy, memory_size Size, size_t Alignment);
+
+/// Free the block at Ptr and merge it with its buddy, recursively.
+///
+/// \param Ptr Should have been allocated from this buddy allocator. Pointers
+///            that were not, or that were freed already, are ignored. May be
+///            \c nullptr.
+void
+BuddyFree(buddy_allocator* Buddy, void* Ptr);
+
+/// The size of the block that was handed out for Ptr.
+///
+/// \return 0 if Ptr is not currently allocated from this buddy allocator.
+memory_size
+BuddyBlockSize(buddy_allocator const& Buddy, void* Ptr);
+
+/// The size of all blocks currently handed out.
+memory_size
+BuddyUsed(buddy_allocator const& Buddy);
+
+/// The total amount of memory the buddy allocator manages.
+memory_size
+BuddyCapacity(buddy_allocator const& Buddy);
+
+/// The size of the biggest block that could be allocated right now.
+memory_size
+BuddyLargestFreeBlock(buddy_allocator const& Buddy);
+
+/// The amount of free memory that is NOT part of the largest free block.
+///
+/// Zero means all free memory is available as a single block. The closer this
+/// is to the free size, the more scattered the free memory is.
+memory_size
+BuddyFragmentation(buddy_allocator const& Buddy);
+
+/// Get an allocator that allocates from the given buddy allocator.
+///
+/// Reallocating within the size of the current block happens in place.
+allocator
+AllocatorFrom(buddy_allocator* Buddy);
+
+/// Allocate Num elements of type T and construct them with Args.
+///
+/// \see MemConstruct
+/// \return An empty slice if there is no free block big enough.
+template<typename T, typename... ArgTypes>
+slice<T>
+BuddyAllocate(buddy_allocator* Buddy, size_t Num, ArgTypes&&... Args)
+{
+  if(Num > IntMaxValue<size_t>() / sizeof(T))
+    return {};
+
+  auto Ptr = Reinterpret<T*>(BuddyAllocateBytes(Buddy, Num * SizeOf<T>(), alignof(T)));
+  if(Ptr == nullptr)
+    return {};
+
+  MemConstruct(Num, Ptr, Forward<ArgTypes>(Args)...);
+  return Slice(Num, Ptr);
+}
+
+//]]~~
@@ -2,6 +2,15 @@
 #include "Common.hpp"
 
 #include <cmath>
+#include <atomic>
+
+#if defined(BB_Platform_x64)
+  #if defined(BB_Platform_Windows)
+    #include <intrin.h>
+  #else
+    #include <cpuid.h>
+  #endif
+#endif
 
 //~~[[
 
@@ -113,4 +122,93 @@ auto
   return Abs(A - B) <= Epsilon;
 }
 
+#if defined(BB_Platform_x64)
+
+static void
+CpuId(uint32 Leaf, uint32 SubLeaf, uint32 (&Out_Registers)[4])
+{
+#if defined(BB_Platform_Windows)
+  int Registers[4];
+  __cpuidex(Registers, int(Leaf), int(SubLeaf));
+  for(int Index = 0; Index < 4; ++Index)
+    Out_Registers[Index] = uint32(Registers[Index]);
+#else
+  __cpuid_count(Leaf, SubLeaf, Out_Registers[0], Out_Registers[1], Out_Registers[2], Out_Registers[3]);
+#endif
+}
+
+/// The register state the OS saves on context switches.
+static uint64
+CpuEnabledStateMask()
+{
+#if defined(BB_Platform_Windows)
+  return _xgetbv(0);
+#else
+  uint32 Low, High;
+  __asm__ volatile("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+  return (uint64(High) << 32) | Low;
+#endif
+}
+
+static uint32
+CpuDetectFeatures()
+{
+  uint32 Registers[4];
+  CpuId(0, 0, Registers);
+  auto const MaxLeaf = Registers[0];
+
+  // SSE2 is part of x64.
+  uint32 Features = Cpu_SSE2;
+
+  CpuId(1, 0, Registers);
+  auto const Ecx = Registers[2];
+  if(IsBitSet(Ecx, 9u))  Features |= Cpu_SSSE3;
+  if(IsBitSet(Ecx, 19u)) Features |= Cpu_SSE41;
+  if(IsBitSet(Ecx, 20u)) Features |= Cpu_SSE42;
+  if(IsBitSet(Ecx, 1u))  Features |= Cpu_PCLMULQDQ;
+
+  // AVX needs the OS to save the upper halves of the YMM registers.
+  auto const OSUsesXSave = IsBitSet(Ecx, 27u);
+  auto const HasAVX = IsBitSet(Ecx, 28u) && OSUsesXSave && (CpuEnabledStateMask() & 0x6) == 0x6;
+  if(HasAVX)
+  {
+    Features |= Cpu_AVX;
+    if(MaxLeaf >= 7)
+    {
+      CpuId(7, 0, Registers);
+      if(IsBitSet(Registers[1], 5u))
+        Features |= Cpu_AVX2;
+    }
+  }
+
+  return Features;
+}
+
+#else
+
+static uint32
+CpuDetectFeatures()
+{
+  return 0;
+}
+
+#endif
+
+static std::atomic<uint32> CpuFeatureMask{ ~uint32(0) };
+
+auto
+::CpuFeatures()
+  -> uint32
+{
+  static uint32 const DetectedFeatures = CpuDetectFeatures();
+  return DetectedFeatures & CpuFeatureMask.load(std::memory_order_relaxed);
+}
+
+auto
+::CpuRestrictFeatures(uint32 Mask)
+  -> void
+{
+  CpuFeatureMask.store(Mask, std::memory_order_relaxed);
+}
+
 //]]~~
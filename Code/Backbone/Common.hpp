@@ -3,11 +3,17 @@
 // TODO: Get rid of this?
 #include <limits>
 #include <cmath> // floor, ceil, round, etc.
+#include <type_traits> // std::is_trivially_*
+
+#if defined(BB_Platform_Windows)
+  #include <intrin.h> // _BitScanForward64, _BitScanReverse64
+  #include <stdlib.h> // _byteswap_ushort, _byteswap_ulong, _byteswap_uint64
+#endif
 
 //~~[[
 
-#if !defined(BB_Platform_Windows)
-  #error The Backbone is only working on windows platforms for now.
+#if !defined(BB_Platform_Windows) && !defined(BB_Platform_Linux)
+  #error The Backbone is only working on windows and linux platforms for now.
 #endif
 
 #if !defined(BB_Inline)
@@ -18,6 +24,18 @@
   #define BB_ForceInline inline
 #endif
 
+/// Compile a single function for a more advanced instruction set than the
+/// rest of the code, e.g. BB_TargetFeatures("avx2"). Such functions must
+/// only be called after checking CpuHasFeature. MSVC accepts all intrinsics
+/// anyway.
+#if !defined(BB_TargetFeatures)
+  #if defined(BB_Platform_Linux)
+    #define BB_TargetFeatures(Features) __attribute__((target(Features)))
+  #else
+    #define BB_TargetFeatures(Features)
+  #endif
+#endif
+
 #define NoOp do{  }while(0)
 
 #define Crash() *(int*)nullptr = 0
@@ -201,6 +219,125 @@ constexpr bool IsBitSet(uint64 Bits, uint64 Position) { return !!(Bits & (uint64
 
 constexpr bool IsPowerOfTwo(size_t Value) { return Value < 1 ? false : (Value & (Value - 1)) == 0; }
 
+/// The index of the lowest set bit in Value. Value must not be zero.
+inline uint32
+FindFirstSetBit(uint64 Value)
+{
+#if defined(BB_Platform_Windows)
+  unsigned long Index;
+  _BitScanForward64(&Index, Value);
+  return uint32(Index);
+#else
+  return uint32(__builtin_ctzll(Value));
+#endif
+}
+
+/// The index of the highest set bit in Value. Value must not be zero.
+inline uint32
+FindLastSetBit(uint64 Value)
+{
+#if defined(BB_Platform_Windows)
+  unsigned long Index;
+  _BitScanReverse64(&Index, Value);
+  return uint32(Index);
+#else
+  return uint32(63 - __builtin_clzll(Value));
+#endif
+}
+
+/// Reverse the order of the bytes in Value. Compiles to a single instruction.
+inline uint16
+ByteSwap(uint16 Value)
+{
+#if defined(BB_Platform_Windows)
+  return _byteswap_ushort(Value);
+#else
+  return __builtin_bswap16(Value);
+#endif
+}
+
+/// Reverse the order of the bytes in Value. Compiles to a single instruction.
+inline uint32
+ByteSwap(uint32 Value)
+{
+#if defined(BB_Platform_Windows)
+  return _byteswap_ulong(Value);
+#else
+  return __builtin_bswap32(Value);
+#endif
+}
+
+/// Reverse the order of the bytes in Value. Compiles to a single instruction.
+inline uint64
+ByteSwap(uint64 Value)
+{
+#if defined(BB_Platform_Windows)
+  return _byteswap_uint64(Value);
+#else
+  return __builtin_bswap64(Value);
+#endif
+}
+
+inline int16 ByteSwap(int16 Value) { return int16(ByteSwap(uint16(Value))); }
+inline int32 ByteSwap(int32 Value) { return int32(ByteSwap(uint32(Value))); }
+inline int64 ByteSwap(int64 Value) { return int64(ByteSwap(uint64(Value))); }
+
+/// The order in which the bytes of multi-byte values are stored.
+enum endian
+{
+  Endian_Little,
+  Endian_Big,
+
+  /// All supported platforms are little-endian.
+  Endian_Native = Endian_Little,
+};
+
+/// Instruction set extensions that are detected at runtime.
+///
+/// \see CpuHasFeature
+enum cpu_feature
+{
+  Cpu_SSE2      = 1 << 0,
+  Cpu_SSSE3     = 1 << 1,
+  Cpu_SSE41     = 1 << 2,
+  Cpu_SSE42     = 1 << 3,
+  Cpu_PCLMULQDQ = 1 << 4,
+  Cpu_AVX       = 1 << 5,
+  Cpu_AVX2      = 1 << 6,
+};
+
+/// All cpu_feature flags the CPU and OS support, minus the ones disabled with
+/// CpuRestrictFeatures. Detected once on first use.
+uint32
+CpuFeatures();
+
+/// Whether the given instruction set extension may be used.
+inline bool
+CpuHasFeature(cpu_feature Feature) { return (CpuFeatures() & Feature) != 0; }
+
+/// Pretend that only the features in Mask are available, e.g. to test the
+/// fallback paths of vectorized code. Pass ~0u to allow all of them again.
+void
+CpuRestrictFeatures(uint32 Mask);
+
+// Alignment arithmetic. Alignment must always be a power of two.
+
+/// Round Value up to the next multiple of Alignment.
+constexpr size_t AlignUp(size_t Value, size_t Alignment) { return (Value + (Alignment - 1)) & ~(Alignment - 1); }
+
+/// Round Value down to the previous multiple of Alignment.
+constexpr size_t AlignDown(size_t Value, size_t Alignment) { return Value & ~(Alignment - 1); }
+
+/// Whether Value is a multiple of Alignment.
+constexpr bool IsAligned(size_t Value, size_t Alignment) { return (Value & (Alignment - 1)) == 0; }
+
+constexpr memory_size AlignUp(memory_size Size, size_t Alignment) { return { (Size.InternalBytes + (Alignment - 1)) & ~uint64(Alignment - 1) }; }
+constexpr memory_size AlignDown(memory_size Size, size_t Alignment) { return { Size.InternalBytes & ~uint64(Alignment - 1) }; }
+constexpr bool IsAligned(memory_size Size, size_t Alignment) { return (Size.InternalBytes & (Alignment - 1)) == 0; }
+
+/// The size of a cache line on all supported platforms.
+constexpr size_t CacheLineSize = 64;
+
 //
 // ================
 //
@@ -279,8 +416,43 @@ MemAddOffset(t_pointer_type* Pointer, OffsetType Offset)
   return MemAddByteOffset(Pointer, Offset * ToBytes(SizeOf<t_pointer_type>()));
 }
 
-// TODO: This is MSVC specific right now.
-template<typename T> struct impl_is_pod { static constexpr bool Value = __is_pod(T); };
+/// Advance Pointer to the next address that is a multiple of Alignment.
+template<typename t_pointer_type>
+inline t_pointer_type*
+AlignUp(t_pointer_type* Pointer, size_t Alignment)
+{
+  return reinterpret_cast<t_pointer_type*>(AlignUp(reinterpret_cast<size_t>(Pointer), Alignment));
+}
+
+/// Move Pointer back to the previous address that is a multiple of Alignment.
+template<typename t_pointer_type>
+inline t_pointer_type*
+AlignDown(t_pointer_type* Pointer, size_t Alignment)
+{
+  return reinterpret_cast<t_pointer_type*>(AlignDown(reinterpret_cast<size_t>(Pointer), Alignment));
+}
+
+/// Whether the address of Pointer is a multiple of Alignment.
+template<typename t_pointer_type>
+inline bool
+IsAligned(t_pointer_type* Pointer, size_t Alignment)
+{
+  return IsAligned(reinterpret_cast<size_t>(Pointer), Alignment);
+}
+
+/// Wraps a value of type T so that it starts on a cache line of its own and
+/// no other data shares the cache lines it occupies.
+///
+/// Use this for data that is frequently written by one thread while other
+/// threads access data right next to it, which otherwise leads to false
+/// sharing.
+template<typename T>
+struct alignas(CacheLineSize) cache_line_padded
+{
+  T Value;
+};
+
+template<typename T> struct impl_is_pod { static constexpr bool Value = std::is_trivial<T>::value && std::is_standard_layout<T>::value; };
 template<>           struct impl_is_pod<void>          : public impl_is_pod<uint8>          {};
 template<>           struct impl_is_pod<void const>    : public impl_is_pod<uint8 const>    {};
 template<>           struct impl_is_pod<void volatile> : public impl_is_pod<uint8 volatile> {};
@@ -288,10 +460,91 @@ template<>           struct impl_is_pod<void volatile> : public impl_is_pod<uint
 /// Whether the given type T is a "plain old data" (POD) type.
 ///
 /// The type 'void' is also considered POD.
+///
+/// The Mem* functions use the finer traits below rather than this one.
 template<typename T>
 constexpr bool
 IsPOD() { return impl_is_pod<T>::Value; }
 
+template<typename T> struct impl_is_trivially_default_constructible { static constexpr bool Value = std::is_trivially_default_constructible<T>::value; };
+template<>           struct impl_is_trivially_default_constructible<void>          : public impl_is_trivially_default_constructible<uint8>          {};
+template<>           struct impl_is_trivially_default_constructible<void const>    : public impl_is_trivially_default_constructible<uint8 const>    {};
+template<>           struct impl_is_trivially_default_constructible<void volatile> : public impl_is_trivially_default_constructible<uint8 volatile> {};
+
+/// Whether default-constructing a T does nothing, i.e. leaves its memory as it
+/// is.
+template<typename T>
+constexpr bool
+IsTriviallyDefaultConstructible() { return impl_is_trivially_default_constructible<T>::Value; }
+
+template<typename T> struct impl_is_trivially_copyable { static constexpr bool Value = std::is_trivially_copyable<T>::value; };
+template<>           struct impl_is_trivially_copyable<void>          : public impl_is_trivially_copyable<uint8>          {};
+template<>           struct impl_is_trivially_copyable<void const>    : public impl_is_trivially_copyable<uint8 const>    {};
+template<>           struct impl_is_trivially_copyable<void volatile> : public impl_is_trivially_copyable<uint8 volatile> {};
+
+/// Whether objects of type T can be copied by copying their bytes.
+template<typename T>
+constexpr bool
+IsTriviallyCopyable() { return impl_is_trivially_copyable<T>::Value; }
+
+template<typename T> struct impl_is_trivially_destructible { static constexpr bool Value = std::is_trivially_destructible<T>::value; };
+template<>           struct impl_is_trivially_destructible<void>          : public impl_is_trivially_destructible<uint8>          {};
+template<>           struct impl_is_trivially_destructible<void const>    : public impl_is_trivially_destructible<uint8 const>    {};
+template<>           struct impl_is_trivially_destructible<void volatile> : public impl_is_trivially_destructible<uint8 volatile> {};
+
+/// Whether destructing a T does nothing.
+template<typename T>
+constexpr bool
+IsTriviallyDestructible() { return impl_is_trivially_destructible<T>::Value; }
+
+/// Specialize this with `Value = true` to mark T as zero-initializable.
+///
+/// \see IsZeroInitializable
+template<typename T> struct impl_is_zero_initializable
+{
+  // Null member pointers are not all zero bits on every ABI.
+  static constexpr bool Value = std::is_trivially_default_constructible<T>::value &&
+                                std::is_trivially_copyable<T>::value &&
+                                !std::is_member_pointer<T>::value;
+};
+template<>           struct impl_is_zero_initializable<void>          : public impl_is_zero_initializable<uint8>          {};
+template<>           struct impl_is_zero_initializable<void const>    : public impl_is_zero_initializable<uint8 const>    {};
+template<>           struct impl_is_zero_initializable<void volatile> : public impl_is_zero_initializable<uint8 volatile> {};
+
+/// Whether a default-constructed T is the same as a T with all bytes set to
+/// zero.
+///
+/// Trivial types are zero-initializable by default. Types with default member
+/// initializers of zero, like `int Num = 0;`, can opt in:
+/// \code
+/// template<> struct impl_is_zero_initializable<my_array> { static constexpr bool Value = true; };
+/// \endcode
+template<typename T>
+constexpr bool
+IsZeroInitializable() { return impl_is_zero_initializable<T>::Value; }
+
+/// Specialize this with `Value = true` to mark T as trivially relocatable.
+///
+/// \see IsTriviallyRelocatable
+template<typename T> struct impl_is_trivially_relocatable { static constexpr bool Value = IsTriviallyCopyable<T>() && IsTriviallyDestructible<T>(); };
+template<>           struct impl_is_trivially_relocatable<void>          : public impl_is_trivially_relocatable<uint8>          {};
+template<>           struct impl_is_trivially_relocatable<void const>    : public impl_is_trivially_relocatable<uint8 const>    {};
+template<>           struct impl_is_trivially_relocatable<void volatile> : public impl_is_trivially_relocatable<uint8 volatile> {};
+
+/// Whether objects of type T can be moved to a new address by copying their
+/// bytes, without calling the move constructor on the new address and the
+/// destructor on the old one.
+///
+/// That holds for most types, unless they point into themselves or register
+/// their address somewhere. Trivially copyable and destructible types are
+/// trivially relocatable, all others have to opt in:
+/// \code
+/// template<> struct impl_is_trivially_relocatable<my_string> { static constexpr bool Value = true; };
+/// \endcode
+template<typename T>
+constexpr bool
+IsTriviallyRelocatable() { return impl_is_trivially_relocatable<T>::Value; }
+
 
 template<typename NumberType> struct impl_negate { static constexpr NumberType Do(NumberType Value) { return -Value; } };
 template<> struct impl_negate<uint8>  { static constexpr uint8  Do(uint8  Value) { return  Value; } };
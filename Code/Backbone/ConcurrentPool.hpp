@@ -0,0 +1,272 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Memory.hpp"
+#include "Allocator.hpp"
+#include "AllocationStats.hpp"
+#include "VirtualMemory.hpp"
+
+#include <atomic>
+
+//~~[[
+
+RESERVE_PREFIX(ConcurrentPool);
+
+/// A thread-safe, lock-free typed allocator for objects of a fixed size.
+///
+/// Unlike pool<T>, objects may be created on one thread and destroyed on
+/// another without any locking, e.g. for messages passed from producer to
+/// consumer threads.
+///
+/// All slots live in a single range of virtual memory that is reserved and
+/// committed in ConcurrentPoolInit, so the capacity is fixed. Physical memory
+/// is only used for slots that were touched at least once.
+///
+/// Free slots are kept on a Treiber stack, i.e. a singly linked list that is
+/// modified with a compare-and-swap on its head. Slots are linked by their
+/// 32 bit index instead of a pointer, which leaves room for a 32 bit tag in
+/// the head that is incremented on every modification. That prevents the ABA
+/// problem: a pop that raced with other threads popping and pushing the same
+/// slot back fails instead of corrupting the list.
+///
+/// Usage:
+/// \code
+/// concurrent_pool<message> Messages;
+/// ConcurrentPoolInit(&Messages, 4096);
+/// Defer [&](){ ConcurrentPoolFinalize(&Messages); };
+///
+/// // Producer thread:
+/// message* Message = ConcurrentPoolCreate(&Messages, /* ... */);
+///
+/// // Consumer thread:
+/// ConcurrentPoolDestroy(&Messages, Message);
+/// \endcode
+template<typename T>
+struct concurrent_pool
+{
+  using element_type = T;
+
+  union slot
+  {
+    /// Index + 1 of the next free slot, 0 for the end of the list.
+    std::atomic<uint32> NextFree;
+    alignas(T) uint8 Storage[sizeof(T)];
+  };
+
+  /// All slots, contiguous in memory.
+  slot* Slots;
+
+  /// The maximum number of objects that can be alive at the same time.
+  uint32 Capacity;
+
+  /// Tag in the upper 32 bits, index + 1 of the first free slot in the lower
+  /// 32 bits.
+  cache_line_padded<std::atomic<uint64>> FreeHead;
+
+  /// Slots with an index from here on were never used.
+  cache_line_padded<std::atomic<uint64>> NextUnused;
+
+  /// Where to record allocations. May be \c nullptr.
+  ///
+  /// \see allocation_stats
+  allocation_stats* Stats;
+};
+
+template<typename T>
+memory_size
+ImplConcurrentPoolReserveSize(uint32 Capacity)
+{
+  auto const PageSize = Convert<size_t>(ToBytes(VirtualMemPageSize()));
+  return AlignUp(Capacity * SizeOf<typename concurrent_pool<T>::slot>(), PageSize);
+}
+
+/// \param Capacity The maximum number of objects alive at the same time.
+///
+/// \return \c false if the memory could not be reserved.
+template<typename T>
+bool
+ConcurrentPoolInit(concurrent_pool<T>* Pool, uint32 Capacity)
+{
+  using slot = typename concurrent_pool<T>::slot;
+
+  // Slots are page aligned at the start and sized to a multiple of their
+  // alignment, so every slot is aligned properly.
+  static_assert(alignof(slot) <= 4096, "Alignment of T is too big.");
+
+  Assert(Pool);
+  Pool->Slots = nullptr;
+  Pool->Capacity = 0;
+  Pool->FreeHead.Value.store(0, std::memory_order_relaxed);
+  Pool->NextUnused.Value.store(0, std::memory_order_relaxed);
+  Pool->Stats = nullptr;
+
+  if(Capacity == 0)
+    return false;
+
+  auto const Size = ImplConcurrentPoolReserveSize<T>(Capacity);
+  auto Ptr = VirtualMemReserve(Size);
+  if(Ptr == nullptr)
+    return false;
+
+  if(!VirtualMemCommit(Ptr, Size))
+  {
+    VirtualMemRelease(Ptr, Size);
+    return false;
+  }
+
+  Pool->Slots = Reinterpret<slot*>(Ptr);
+  Pool->Capacity = Capacity;
+  return true;
+}
+
+/// Release all memory of the pool.
+///
+/// Objects that are still alive are NOT destructed. Must not be called while
+/// other threads still use the pool.
+template<typename T>
+void
+ConcurrentPoolFinalize(concurrent_pool<T>* Pool)
+{
+  Assert(Pool);
+  if(Pool->Slots)
+    VirtualMemRelease(Pool->Slots, ImplConcurrentPoolReserveSize<T>(Pool->Capacity));
+
+  Pool->Slots = nullptr;
+  Pool->Capacity = 0;
+}
+
+template<typename T>
+typename concurrent_pool<T>::slot*
+ImplConcurrentPoolAllocateSlot(concurrent_pool<T>* Pool)
+{
+  using slot = typename concurrent_pool<T>::slot;
+
+  Assert(Pool);
+  Assert(Pool->Slots); // Pool not initialized?
+
+  slot* Slot = nullptr;
+
+  // Pop from the free list.
+  auto Head = Pool->FreeHead.Value.load(std::memory_order_acquire);
+  while(uint32(Head) != 0)
+  {
+    auto Candidate = &Pool->Slots[uint32(Head) - 1];
+
+    // Candidate may be popped and reused by another thread at any moment, so
+    // this may read garbage. In that case the tag has changed and the
+    // exchange below fails.
+    auto const Next = Candidate->NextFree.load(std::memory_order_relaxed);
+    auto const NewHead = ((Head >> 32) + 1) << 32 | Next;
+    if(Pool->FreeHead.Value.compare_exchange_weak(Head, NewHead, std::memory_order_acquire, std::memory_order_acquire))
+    {
+      Slot = Candidate;
+      break;
+    }
+  }
+
+  if(Slot == nullptr)
+  {
+    // Take a fresh slot.
+    auto const Index = Pool->NextUnused.Value.fetch_add(1, std::memory_order_relaxed);
+    if(Index >= Pool->Capacity)
+      return nullptr;
+
+    Slot = &Pool->Slots[Index];
+  }
+
+  AllocStatsRecordAllocation(Pool->Stats, SizeOf<slot>());
+  return Slot;
+}
+
+template<typename T>
+void
+ImplConcurrentPoolFreeSlot(concurrent_pool<T>* Pool, typename concurrent_pool<T>::slot* Slot)
+{
+  auto const Index = uint32(Slot - Pool->Slots);
+  Assert(Index < Pool->Capacity);
+
+  auto Head = Pool->FreeHead.Value.load(std::memory_order_relaxed);
+  uint64 NewHead;
+  do
+  {
+    Slot->NextFree.store(uint32(Head), std::memory_order_relaxed);
+    NewHead = ((Head >> 32) + 1) << 32 | (Index + 1);
+  }
+  while(!Pool->FreeHead.Value.compare_exchange_weak(Head, NewHead, std::memory_order_release, std::memory_order_relaxed));
+
+  AllocStatsRecordFree(Pool->Stats, SizeOf<typename concurrent_pool<T>::slot>());
+}
+
+/// Get a slot for a new object and construct it with Args.
+///
+/// Thread-safe.
+///
+/// \see MemConstruct
+/// \return \c nullptr if all slots are in use.
+template<typename T, typename... ArgTypes>
+T*
+ConcurrentPoolCreate(concurrent_pool<T>* Pool, ArgTypes&&... Args)
+{
+  auto Slot = ImplConcurrentPoolAllocateSlot(Pool);
+  if(Slot == nullptr)
+    return nullptr;
+
+  auto Object = Reinterpret<T*>(&Slot->Storage[0]);
+  MemConstruct(1, Object, Forward<ArgTypes>(Args)...);
+  return Object;
+}
+
+/// Destruct the given object and put its slot back on the free list.
+///
+/// Thread-safe. The object may have been created on any thread.
+///
+/// \param Object Must have been created from this pool. May be \c nullptr.
+template<typename T>
+void
+ConcurrentPoolDestroy(concurrent_pool<T>* Pool, T* Object)
+{
+  Assert(Pool);
+  if(Object == nullptr)
+    return;
+
+  MemDestruct(1, Object);
+  ImplConcurrentPoolFreeSlot(Pool, Reinterpret<typename concurrent_pool<T>::slot*>(Object));
+}
+
+template<typename T>
+void*
+ImplConcurrentPoolAllocatorAllocate(void* Context, memory_size Size, size_t Alignment)
+{
+  using slot = typename concurrent_pool<T>::slot;
+
+  // Only requests that fit into a single slot can be served.
+  if(Size > SizeOf<slot>() || Alignment > alignof(slot))
+    return nullptr;
+
+  return ImplConcurrentPoolAllocateSlot(Reinterpret<concurrent_pool<T>*>(Context));
+}
+
+template<typename T>
+void
+ImplConcurrentPoolAllocatorFree(void* Context, void* Ptr, memory_size Size)
+{
+  ImplConcurrentPoolFreeSlot(Reinterpret<concurrent_pool<T>*>(Context), Reinterpret<typename concurrent_pool<T>::slot*>(Ptr));
+}
+
+/// Get an allocator that hands out the slots of the given pool.
+///
+/// Only allocations of at most one slot in size and alignment succeed. No
+/// objects are constructed or destructed by that allocator.
+template<typename T>
+allocator
+AllocatorFrom(concurrent_pool<T>* Pool)
+{
+  allocator Result;
+  Result.Context = Pool;
+  Result.AllocateFunc = ImplConcurrentPoolAllocatorAllocate<T>;
+  Result.ReallocateFunc = nullptr;
+  Result.FreeFunc = ImplConcurrentPoolAllocatorFree<T>;
+  return Result;
+}
+
+//]]~~
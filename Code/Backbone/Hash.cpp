@@ -0,0 +1,431 @@
+#include "Hash.hpp"
+
+#include <cstring>
+
+#if defined(BB_Platform_x64)
+  #include <immintrin.h>
+#endif
+
+//~~[[
+
+static inline void
+HashMultiply(uint64* A, uint64* B)
+{
+#if defined(BB_Platform_Windows)
+  *A = _umul128(*A, *B, B);
+#else
+  auto const Result = static_cast<unsigned __int128>(*A) * *B;
+  *A = uint64(Result);
+  *B = uint64(Result >> 64);
+#endif
+}
+
+static inline uint64
+HashMix(uint64 A, uint64 B)
+{
+  HashMultiply(&A, &B);
+  return A ^ B;
+}
+
+static inline uint64
+HashRead8(uint8 const* Ptr)
+{
+  uint64 Result;
+  std::memcpy(&Result, Ptr, 8);
+  return Result;
+}
+
+static inline uint64
+HashRead4(uint8 const* Ptr)
+{
+  uint32 Result;
+  std::memcpy(&Result, Ptr, 4);
+  return Result;
+}
+
+static inline uint64
+HashPrepareSeed(uint64 Seed)
+{
+  return Seed ^ HashMix(Seed ^ ImplHashSecret[0], ImplHashSecret[1]);
+}
+
+/// One 48 byte block, spread over the three multiply chains.
+static inline void
+HashBlock(uint64* State, uint8 const* Ptr)
+{
+  State[0] = HashMix(HashRead8(Ptr)      ^ ImplHashSecret[1], HashRead8(Ptr + 8)  ^ State[0]);
+  State[1] = HashMix(HashRead8(Ptr + 16) ^ ImplHashSecret[2], HashRead8(Ptr + 24) ^ State[1]);
+  State[2] = HashMix(HashRead8(Ptr + 32) ^ ImplHashSecret[3], HashRead8(Ptr + 40) ^ State[2]);
+}
+
+static inline uint64
+HashFinish(uint64 Seed, uint64 A, uint64 B, uint64 TotalSize)
+{
+  A ^= ImplHashSecret[1];
+  B ^= Seed;
+  HashMultiply(&A, &B);
+  return HashMix(A ^ ImplHashSecret[0] ^ TotalSize, B ^ ImplHashSecret[1]);
+}
+
+/// Inputs of up to 16 bytes.
+static uint64
+HashSmall(uint64 Seed, uint8 const* Ptr, size_t Size)
+{
+  uint64 A = 0;
+  uint64 B = 0;
+  if(Size >= 4)
+  {
+    size_t const Offset = (Size >> 3) << 2;
+    A = (HashRead4(Ptr) << 32) | HashRead4(Ptr + Offset);
+    B = (HashRead4(Ptr + Size - 4) << 32) | HashRead4(Ptr + Size - 4 - Offset);
+  }
+  else if(Size > 0)
+  {
+    A = (uint64(Ptr[0]) << 16) | (uint64(Ptr[Size >> 1]) << 8) | Ptr[Size - 1];
+  }
+  return HashFinish(Seed, A, B, Size);
+}
+
+/// The last 1 to 48 bytes of an input longer than 16 bytes.
+///
+/// The final 16 bytes are read as a whole, so they may reach up to 15 bytes
+/// back in front of Ptr.
+static uint64
+HashTail(uint64 Seed, uint8 const* Ptr, size_t NumRemaining, uint64 TotalSize)
+{
+  while(NumRemaining > 16)
+  {
+    Seed = HashMix(HashRead8(Ptr) ^ ImplHashSecret[1], HashRead8(Ptr + 8) ^ Seed);
+    Ptr += 16;
+    NumRemaining -= 16;
+  }
+
+  auto const A = HashRead8(Ptr + NumRemaining - 16);
+  auto const B = HashRead8(Ptr + NumRemaining - 8);
+  return HashFinish(Seed, A, B, TotalSize);
+}
+
+auto
+::MemHashBytes(memory_size Size, void const* Data, uint64 Seed)
+  -> uint64
+{
+  auto Ptr = Reinterpret<uint8 const*>(Data);
+  auto const NumBytes = ToBytes(Size);
+
+  Seed = HashPrepareSeed(Seed);
+  if(NumBytes <= 16)
+    return HashSmall(Seed, Ptr, NumBytes);
+
+  auto NumRemaining = NumBytes;
+  if(NumRemaining > 48)
+  {
+    uint64 State[3] = { Seed, Seed, Seed };
+    do
+    {
+      HashBlock(State, Ptr);
+      Ptr += 48;
+      NumRemaining -= 48;
+    } while(NumRemaining > 48);
+    Seed = State[0] ^ State[1] ^ State[2];
+  }
+
+  return HashTail(Seed, Ptr, NumRemaining, NumBytes);
+}
+
+auto
+::HashStreamInit(hash_stream* Stream, uint64 Seed)
+  -> void
+{
+  Seed = HashPrepareSeed(Seed);
+  Stream->State[0] = Seed;
+  Stream->State[1] = Seed;
+  Stream->State[2] = Seed;
+  Stream->NumTotalBytes = 0;
+  Stream->NumBuffered = 0;
+}
+
+auto
+::HashStreamUpdate(hash_stream* Stream, memory_size Size, void const* Data)
+  -> void
+{
+  auto Ptr = Reinterpret<uint8 const*>(Data);
+  auto NumRemaining = ToBytes(Size);
+  Stream->NumTotalBytes += NumRemaining;
+
+  // A block may only go into the state once it's clear that it isn't the
+  // last one, i.e. when at least one more byte follows it.
+  if(Stream->NumBuffered)
+  {
+    auto const NumToBuffer = Min(48 - Stream->NumBuffered, NumRemaining);
+    std::memcpy(Stream->Buffer + 16 + Stream->NumBuffered, Ptr, NumToBuffer);
+    Stream->NumBuffered += NumToBuffer;
+    Ptr += NumToBuffer;
+    NumRemaining -= NumToBuffer;
+    if(NumRemaining == 0)
+      return;
+
+    HashBlock(Stream->State, Stream->Buffer + 16);
+    std::memcpy(Stream->Buffer, Stream->Buffer + 48, 16);
+    Stream->NumBuffered = 0;
+  }
+
+  if(NumRemaining > 48)
+  {
+    do
+    {
+      HashBlock(Stream->State, Ptr);
+      Ptr += 48;
+      NumRemaining -= 48;
+    } while(NumRemaining > 48);
+    std::memcpy(Stream->Buffer, Ptr - 16, 16);
+  }
+
+  std::memcpy(Stream->Buffer + 16, Ptr, NumRemaining);
+  Stream->NumBuffered = NumRemaining;
+}
+
+auto
+::HashStreamFinalize(hash_stream const& Stream)
+  -> uint64
+{
+  auto const NumBytes = Stream.NumTotalBytes;
+  auto const Pending = Stream.Buffer + 16;
+
+  // Nothing went into the state yet, so all bytes are in the buffer.
+  if(NumBytes <= 16)
+    return HashSmall(Stream.State[0], Pending, size_t(NumBytes));
+  if(NumBytes <= 48)
+    return HashTail(Stream.State[0], Pending, size_t(NumBytes), NumBytes);
+
+  auto const Seed = Stream.State[0] ^ Stream.State[1] ^ Stream.State[2];
+  return HashTail(Seed, Pending, Stream.NumBuffered, NumBytes);
+}
+
+enum
+{
+  /// Block sizes of the three-way interleaved CRC-32C. Buffers of at least
+  /// three long blocks go through the long loop, the rest of at least three
+  /// short blocks through the short one.
+  Hash_Crc32cLongBlockSize = 8192,
+  Hash_Crc32cShortBlockSize = 256,
+};
+
+/// Lookup tables for CRC-32C, built on first use.
+struct hash_crc32c_tables;
+
+static void
+HashCrc32cBuildTables(hash_crc32c_tables* Tables);
+
+struct hash_crc32c_tables
+{
+  /// Bytes[K][N] is the CRC of byte N followed by K zero bytes.
+  uint32 Bytes[8][256];
+
+  /// Advance a CRC over a long or short block of zero bytes, one table per
+  /// byte of the CRC. Used to combine the CRCs of interleaved blocks.
+  uint32 LongShift[4][256];
+  uint32 ShortShift[4][256];
+
+  hash_crc32c_tables() { HashCrc32cBuildTables(this); }
+};
+
+static void
+HashCrc32cBuildShift(hash_crc32c_tables const* Tables, size_t NumZeroBytes, uint32 (*Shift)[256])
+{
+  // The shift is linear, so it's enough to know where each single bit ends
+  // up. Every other value is a combination of those.
+  uint32 Columns[32];
+  for(uint32 Bit = 0; Bit < 32; ++Bit)
+  {
+    uint32 Crc = uint32(1) << Bit;
+    for(size_t Index = 0; Index < NumZeroBytes; Index += 4)
+    {
+      Crc = Tables->Bytes[3][Crc & 0xFF] ^ Tables->Bytes[2][(Crc >> 8) & 0xFF] ^
+            Tables->Bytes[1][(Crc >> 16) & 0xFF] ^ Tables->Bytes[0][Crc >> 24];
+    }
+    Columns[Bit] = Crc;
+  }
+
+  for(uint32 Byte = 0; Byte < 4; ++Byte)
+  {
+    Shift[Byte][0] = 0;
+    for(uint32 Value = 1; Value < 256; ++Value)
+    {
+      auto const LowestBit = FindFirstSetBit(Value);
+      Shift[Byte][Value] = Shift[Byte][Value & (Value - 1)] ^ Columns[8 * Byte + LowestBit];
+    }
+  }
+}
+
+static void
+HashCrc32cBuildTables(hash_crc32c_tables* Tables)
+{
+  // Reflected Castagnoli polynomial.
+  uint32 const Polynomial = 0x82F63B78;
+
+  for(uint32 Value = 0; Value < 256; ++Value)
+  {
+    uint32 Crc = Value;
+    for(int Bit = 0; Bit < 8; ++Bit)
+      Crc = (Crc >> 1) ^ (Polynomial & (0 - (Crc & 1)));
+    Tables->Bytes[0][Value] = Crc;
+  }
+
+  for(uint32 Value = 0; Value < 256; ++Value)
+  {
+    for(size_t NumZeroBytes = 1; NumZeroBytes < 8; ++NumZeroBytes)
+    {
+      auto const Previous = Tables->Bytes[NumZeroBytes - 1][Value];
+      Tables->Bytes[NumZeroBytes][Value] = (Previous >> 8) ^ Tables->Bytes[0][Previous & 0xFF];
+    }
+  }
+
+  HashCrc32cBuildShift(Tables, Hash_Crc32cLongBlockSize, Tables->LongShift);
+  HashCrc32cBuildShift(Tables, Hash_Crc32cShortBlockSize, Tables->ShortShift);
+}
+
+static hash_crc32c_tables const&
+HashCrc32cTables()
+{
+  static hash_crc32c_tables Tables;
+  return Tables;
+}
+
+/// Slicing-by-8. Crc is the raw state, without the final inversion.
+static uint32
+HashCrc32cTable(uint32 Crc, uint8 const* Ptr, size_t NumBytes)
+{
+  auto const& Tables = HashCrc32cTables();
+
+  while(NumBytes && Reinterpret<size_t>(Ptr) % 8)
+  {
+    Crc = Tables.Bytes[0][(Crc ^ *Ptr++) & 0xFF] ^ (Crc >> 8);
+    --NumBytes;
+  }
+
+  while(NumBytes >= 8)
+  {
+    auto const Word = HashRead8(Ptr) ^ Crc;
+    Crc = Tables.Bytes[7][Word & 0xFF]         ^ Tables.Bytes[6][(Word >> 8) & 0xFF] ^
+          Tables.Bytes[5][(Word >> 16) & 0xFF] ^ Tables.Bytes[4][(Word >> 24) & 0xFF] ^
+          Tables.Bytes[3][(Word >> 32) & 0xFF] ^ Tables.Bytes[2][(Word >> 40) & 0xFF] ^
+          Tables.Bytes[1][(Word >> 48) & 0xFF] ^ Tables.Bytes[0][Word >> 56];
+    Ptr += 8;
+    NumBytes -= 8;
+  }
+
+  while(NumBytes)
+  {
+    Crc = Tables.Bytes[0][(Crc ^ *Ptr++) & 0xFF] ^ (Crc >> 8);
+    --NumBytes;
+  }
+
+  return Crc;
+}
+
+#if defined(BB_Platform_x64)
+
+static inline uint32
+HashCrc32cShift(uint32 const (*Shift)[256], uint32 Crc)
+{
+  return Shift[0][Crc & 0xFF] ^ Shift[1][(Crc >> 8) & 0xFF] ^ Shift[2][(Crc >> 16) & 0xFF] ^ Shift[3][Crc >> 24];
+}
+
+/// The crc32 instruction has a latency of three cycles but can start one
+/// every cycle. Three blocks are therefore processed side by side and their
+/// CRCs combined afterwards.
+BB_TargetFeatures("sse4.2")
+static uint32
+HashCrc32cInterleavedSSE42(uint32 Crc, uint8 const** Ptr, size_t* NumBytes, size_t BlockSize, uint32 const (*Shift)[256])
+{
+  auto Block = *Ptr;
+  while(*NumBytes >= 3 * BlockSize)
+  {
+    uint64 Crc0 = Crc;
+    uint64 Crc1 = 0;
+    uint64 Crc2 = 0;
+    for(auto End = Block + BlockSize; Block < End; Block += 8)
+    {
+      Crc0 = _mm_crc32_u64(Crc0, HashRead8(Block));
+      Crc1 = _mm_crc32_u64(Crc1, HashRead8(Block + BlockSize));
+      Crc2 = _mm_crc32_u64(Crc2, HashRead8(Block + 2 * BlockSize));
+    }
+    Crc = HashCrc32cShift(Shift, uint32(Crc0)) ^ uint32(Crc1);
+    Crc = HashCrc32cShift(Shift, Crc) ^ uint32(Crc2);
+    Block += 2 * BlockSize;
+    *NumBytes -= 3 * BlockSize;
+  }
+  *Ptr = Block;
+  return Crc;
+}
+
+BB_TargetFeatures("sse4.2")
+static uint32
+HashCrc32cSSE42(uint32 Crc, uint8 const* Ptr, size_t NumBytes)
+{
+  auto const& Tables = HashCrc32cTables();
+
+  while(NumBytes && Reinterpret<size_t>(Ptr) % 8)
+  {
+    Crc = _mm_crc32_u8(Crc, *Ptr++);
+    --NumBytes;
+  }
+
+  Crc = HashCrc32cInterleavedSSE42(Crc, &Ptr, &NumBytes, Hash_Crc32cLongBlockSize, Tables.LongShift);
+  Crc = HashCrc32cInterleavedSSE42(Crc, &Ptr, &NumBytes, Hash_Crc32cShortBlockSize, Tables.ShortShift);
+
+  while(NumBytes >= 8)
+  {
+    Crc = uint32(_mm_crc32_u64(Crc, HashRead8(Ptr)));
+    Ptr += 8;
+    NumBytes -= 8;
+  }
+
+  while(NumBytes)
+  {
+    Crc = _mm_crc32_u8(Crc, *Ptr++);
+    --NumBytes;
+  }
+
+  return Crc;
+}
+
+#endif
+
+auto
+::MemCrc32c(memory_size Size, void const* Data)
+  -> uint32
+{
+  return MemCrc32cUpdate(0, Size, Data);
+}
+
+auto
+::MemCrc32cUpdate(uint32 Crc, memory_size Size, void const* Data)
+  -> uint32
+{
+  auto const Ptr = Reinterpret<uint8 const*>(Data);
+  auto const NumBytes = Convert<size_t>(ToBytes(Size));
+
+#if defined(BB_Platform_x64)
+  if(CpuHasFeature(Cpu_SSE42))
+    return ~HashCrc32cSSE42(~Crc, Ptr, NumBytes);
+#endif
+
+  return ~HashCrc32cTable(~Crc, Ptr, NumBytes);
+}
+
+auto
+::SliceCrc32c(slice<uint8 const> Data)
+  -> uint32
+{
+  return MemCrc32cUpdate(0, Bytes(Data.Num), Data.Ptr);
+}
+
+auto
+::SliceCrc32cUpdate(uint32 Crc, slice<uint8 const> Data)
+  -> uint32
+{
+  return MemCrc32cUpdate(Crc, Bytes(Data.Num), Data.Ptr);
+}
+
+//]]~~
@@ -0,0 +1,276 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Slice.hpp"
+
+//~~[[
+
+/// \defgroup Hashing
+///
+/// Fast non-cryptographic 64-bit hashing for hash tables, checksums of
+/// in-memory data, and the like, plus CRC-32C for data that is persisted or
+/// sent elsewhere. Don't use any of it where an attacker picks the input.
+///
+/// The algorithm is the final version of wyhash: 48 bytes per iteration in
+/// three independent 64x64->128 bit multiply chains, which keeps the
+/// multiplier busy every cycle. Inputs of up to 16 bytes take a single
+/// multiplication and a mix.
+///
+/// MemHashBytes, SliceHash, the hash_stream functions and SliceHashConstexpr
+/// all produce the same value for the same bytes and seed. Hash values
+/// depend on the byte order of the platform for element types wider than a
+/// byte.
+///
+/// Usage:
+/// \code
+/// static_assert(SliceHashConstexpr("Position"_S) != 0, "");
+///
+/// switch(SliceHash(Name))
+/// {
+///   case SliceHashConstexpr("Position"_S): /* ... */ break;
+///   case SliceHashConstexpr("Normal"_S):   /* ... */ break;
+/// }
+/// \endcode
+///
+/// @{
+
+RESERVE_PREFIX(Hash);
+
+/// Hash Size bytes at Data.
+uint64
+MemHashBytes(memory_size Size, void const* Data, uint64 Seed = 0);
+
+/// Hash all elements of Slice as one contiguous range of bytes.
+///
+/// Only for element types whose slices compare equal exactly when their
+/// bytes are equal (integers, enums, pointers), so equal slices always hash
+/// equally.
+template<typename ElementType>
+uint64
+SliceHash(slice<ElementType> Slice, uint64 Seed = 0);
+
+/// Same as SliceHash but usable at compile time, e.g. to hash "..."_S
+/// literals for case labels or static tables.
+///
+/// Considerably slower than SliceHash at runtime.
+constexpr uint64
+SliceHashConstexpr(slice<char const> String, uint64 Seed = 0);
+
+/// Hashes data that arrives in pieces.
+///
+/// Feeding the bytes through any number of HashStreamUpdate calls results in
+/// the same hash as passing all of them to MemHashBytes at once.
+///
+/// Usage:
+/// \code
+/// hash_stream Stream;
+/// HashStreamInit(&Stream);
+/// while(auto Chunk = ReceiveChunk())
+///   HashStreamUpdate(&Stream, Chunk);
+/// auto Hash = HashStreamFinalize(Stream);
+/// \endcode
+struct hash_stream
+{
+  /// The three multiply chains.
+  uint64 State[3];
+
+  /// The number of bytes passed to HashStreamUpdate so far.
+  uint64 NumTotalBytes;
+
+  /// The number of bytes in Buffer after the first 16, which are not hashed
+  /// yet.
+  size_t NumBuffered;
+
+  /// The last 16 bytes that went into State, followed by up to one block of
+  /// bytes that did not. The final block may reach back into the former.
+  uint8 Buffer[16 + 48];
+};
+
+/// Start a new hash with the given seed.
+void
+HashStreamInit(hash_stream* Stream, uint64 Seed = 0);
+
+/// Append Size bytes at Data to the hashed data.
+void
+HashStreamUpdate(hash_stream* Stream, memory_size Size, void const* Data);
+
+/// Append all elements of Slice to the hashed data.
+///
+/// \see SliceHash
+template<typename ElementType>
+void
+HashStreamUpdate(hash_stream* Stream, slice<ElementType> Slice);
+
+/// The hash of all bytes passed to HashStreamUpdate so far.
+///
+/// Does not modify the stream, so more data may be appended afterwards.
+uint64
+HashStreamFinalize(hash_stream const& Stream);
+
+/// CRC-32C (Castagnoli) checksum of Size bytes at Data, as used by iSCSI,
+/// ext4 and many storage formats. Catches all burst errors of up to 32 bits,
+/// which makes it the better choice for checksumming persisted data.
+///
+/// CPUs with SSE4.2 compute it with the crc32 instruction on three
+/// interleaved streams, so large buffers are limited by the instruction's
+/// throughput rather than its latency. Others use slicing-by-8 tables.
+uint32
+MemCrc32c(memory_size Size, void const* Data);
+
+/// Continue a CRC-32C over more bytes.
+///
+/// Chaining calls over consecutive pieces of data results in the same
+/// checksum as a single MemCrc32c call over all of them.
+///
+/// Usage:
+/// \code
+/// uint32 Crc = 0;
+/// while(auto Chunk = ReceiveChunk())
+///   Crc = MemCrc32cUpdate(Crc, Bytes(Chunk.Num), Chunk.Ptr);
+/// \endcode
+///
+/// \param Crc 0 for the first piece, else the result of the previous call.
+uint32
+MemCrc32cUpdate(uint32 Crc, memory_size Size, void const* Data);
+
+/// \see MemCrc32c
+uint32
+SliceCrc32c(slice<uint8 const> Data);
+
+/// \see MemCrc32cUpdate
+uint32
+SliceCrc32cUpdate(uint32 Crc, slice<uint8 const> Data);
+
+/// @}
+
+
+//
+// Implementation Details
+//
+
+constexpr uint64 ImplHashSecret[4] =
+{
+  0x2d358dccaa6c78a5ull,
+  0x8bb84b93962eacc9ull,
+  0x4b33a62ed433d4a3ull,
+  0x4d5a2da51de1aa47ull,
+};
+
+/// 64x64->128 bit multiplication out of 32 bit parts. A receives the low
+/// half, B the high half.
+constexpr void
+ImplHashMultiplyConstexpr(uint64& A, uint64& B)
+{
+  uint64 const HighA = A >> 32;
+  uint64 const HighB = B >> 32;
+  uint64 const LowA = A & 0xFFFFFFFF;
+  uint64 const LowB = B & 0xFFFFFFFF;
+
+  uint64 const High = HighA * HighB;
+  uint64 const Middle0 = HighA * LowB;
+  uint64 const Middle1 = HighB * LowA;
+  uint64 const Low = LowA * LowB;
+
+  uint64 const Temp = Low + (Middle0 << 32);
+  uint64 Carry = Temp < Low;
+  uint64 const Result = Temp + (Middle1 << 32);
+  Carry += Result < Temp;
+
+  A = Result;
+  B = High + (Middle0 >> 32) + (Middle1 >> 32) + Carry;
+}
+
+constexpr uint64
+ImplHashMixConstexpr(uint64 A, uint64 B)
+{
+  ImplHashMultiplyConstexpr(A, B);
+  return A ^ B;
+}
+
+/// Little-endian read of NumBytes, at most 8.
+constexpr uint64
+ImplHashReadConstexpr(char const* Ptr, size_t NumBytes)
+{
+  uint64 Result = 0;
+  for(size_t Index = NumBytes; Index > 0; --Index)
+    Result = (Result << 8) | uint8(Ptr[Index - 1]);
+  return Result;
+}
+
+constexpr uint64
+SliceHashConstexpr(slice<char const> String, uint64 Seed)
+{
+  char const* Ptr = String.Ptr;
+  size_t const Size = String.Num;
+
+  Seed ^= ImplHashMixConstexpr(Seed ^ ImplHashSecret[0], ImplHashSecret[1]);
+
+  uint64 A = 0;
+  uint64 B = 0;
+  if(Size <= 16)
+  {
+    if(Size >= 4)
+    {
+      size_t const Offset = (Size >> 3) << 2;
+      A = (ImplHashReadConstexpr(Ptr, 4) << 32) | ImplHashReadConstexpr(Ptr + Offset, 4);
+      B = (ImplHashReadConstexpr(Ptr + Size - 4, 4) << 32) | ImplHashReadConstexpr(Ptr + Size - 4 - Offset, 4);
+    }
+    else if(Size > 0)
+    {
+      A = (uint64(uint8(Ptr[0])) << 16) | (uint64(uint8(Ptr[Size >> 1])) << 8) | uint8(Ptr[Size - 1]);
+    }
+  }
+  else
+  {
+    size_t Remaining = Size;
+    if(Remaining > 48)
+    {
+      uint64 Seed1 = Seed;
+      uint64 Seed2 = Seed;
+      do
+      {
+        Seed  = ImplHashMixConstexpr(ImplHashReadConstexpr(Ptr, 8)      ^ ImplHashSecret[1], ImplHashReadConstexpr(Ptr + 8, 8)  ^ Seed);
+        Seed1 = ImplHashMixConstexpr(ImplHashReadConstexpr(Ptr + 16, 8) ^ ImplHashSecret[2], ImplHashReadConstexpr(Ptr + 24, 8) ^ Seed1);
+        Seed2 = ImplHashMixConstexpr(ImplHashReadConstexpr(Ptr + 32, 8) ^ ImplHashSecret[3], ImplHashReadConstexpr(Ptr + 40, 8) ^ Seed2);
+        Ptr += 48;
+        Remaining -= 48;
+      } while(Remaining > 48);
+      Seed ^= Seed1 ^ Seed2;
+    }
+
+    while(Remaining > 16)
+    {
+      Seed = ImplHashMixConstexpr(ImplHashReadConstexpr(Ptr, 8) ^ ImplHashSecret[1], ImplHashReadConstexpr(Ptr + 8, 8) ^ Seed);
+      Ptr += 16;
+      Remaining -= 16;
+    }
+
+    A = ImplHashReadConstexpr(Ptr + Remaining - 16, 8);
+    B = ImplHashReadConstexpr(Ptr + Remaining - 8, 8);
+  }
+
+  A ^= ImplHashSecret[1];
+  B ^= Seed;
+  ImplHashMultiplyConstexpr(A, B);
+  return ImplHashMixConstexpr(A ^ ImplHashSecret[0] ^ Size, B ^ ImplHashSecret[1]);
+}
+
+template<typename ElementType>
+uint64
+SliceHash(slice<ElementType> Slice, uint64 Seed)
+{
+  static_assert(impl_slice_is_bitwise_comparable<rm_const<ElementType>>::Value,
+                "SliceHash only works on element types that are compared bitwise.");
+  return MemHashBytes(Bytes(Slice.Num * sizeof(ElementType)), Slice.Ptr, Seed);
+}
+
+template<typename ElementType>
+void
+HashStreamUpdate(hash_stream* Stream, slice<ElementType> Slice)
+{
+  static_assert(impl_slice_is_bitwise_comparable<rm_const<ElementType>>::Value,
+                "HashStreamUpdate only works on element types that are compared bitwise.");
+  HashStreamUpdate(Stream, Bytes(Slice.Num * sizeof(ElementType)), Slice.Ptr);
+}
+
+//]]~~
@@ -0,0 +1,497 @@
+#include "Heap.hpp"
+
+#include <cstdlib>
+#include <mutex>
+
+//~~[[
+
+struct heap_slab
+{
+  /// Links within heap::PartialSlabs or heap::EmptySlabs.
+  heap_slab* Next;
+  heap_slab* Prev;
+
+  /// Intrusive list of freed slots.
+  void* FreeList;
+
+  /// Slots from here on up to the end of the slab were never handed out.
+  uint8* Unused;
+
+  uint32 SizeClass;
+  uint32 NumLive;
+  uint32 NumSlots;
+};
+
+/// Prepended to allocations that are too big for slabs.
+struct heap_large_header
+{
+  void* Base;
+  size_t Size;
+};
+
+/// Maps (Size - 1) / 16 to the size class for all sizes up to Heap_MaxSmallSize.
+static uint8 const HeapSizeClassLookup[Heap_MaxSmallSize / 16] =
+{
+  0, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4,
+  5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+  6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+  6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+};
+
+static uint32
+HeapSizeClass(uint64 SlotSize)
+{
+  Assert(SlotSize > 0 && SlotSize <= Heap_MaxSmallSize);
+  return HeapSizeClassLookup[(SlotSize - 1) / 16];
+}
+
+static heap_slab*
+HeapSlabOf(void* Ptr)
+{
+  return Reinterpret<heap_slab*>(AlignDown(Ptr, Heap_SlabSize));
+}
+
+static size_t
+HeapSlotSize(uint32 SizeClass)
+{
+  return size_t(16) << SizeClass;
+}
+
+static size_t
+HeapFirstSlotOffset(uint32 SizeClass)
+{
+  // Slots are naturally aligned to their size, so the first slot starts at
+  // the first multiple of the slot size after the slab header.
+  auto const SlotSize = HeapSlotSize(SizeClass);
+  return AlignUp(sizeof(heap_slab), SlotSize);
+}
+
+static void
+HeapListRemove(heap_slab** List, heap_slab* Slab)
+{
+  if(Slab->Prev) Slab->Prev->Next = Slab->Next;
+  else           *List = Slab->Next;
+  if(Slab->Next) Slab->Next->Prev = Slab->Prev;
+  Slab->Next = nullptr;
+  Slab->Prev = nullptr;
+}
+
+static void
+HeapListPush(heap_slab** List, heap_slab* Slab)
+{
+  Slab->Prev = nullptr;
+  Slab->Next = *List;
+  if(*List) (*List)->Prev = Slab;
+  *List = Slab;
+}
+
+/// Get an empty slab, either a previously used one or a fresh one from the
+/// reserved address space, and prepare it for the given size class.
+static heap_slab*
+HeapAcquireSlab(heap* Heap, uint32 SizeClass)
+{
+  auto Slab = Heap->EmptySlabs;
+  if(Slab)
+  {
+    Heap->EmptySlabs = Slab->Next;
+  }
+  else
+  {
+    Slab = Reinterpret<heap_slab*>(ArenaAllocateBytes(&Heap->Slabs, Bytes(Heap_SlabSize), Heap_SlabSize));
+    if(Slab == nullptr)
+      return nullptr;
+  }
+
+  auto const FirstSlotOffset = HeapFirstSlotOffset(SizeClass);
+  Slab->Next = nullptr;
+  Slab->Prev = nullptr;
+  Slab->FreeList = nullptr;
+  Slab->Unused = Reinterpret<uint8*>(MemAddByteOffset(Slab, FirstSlotOffset));
+  Slab->SizeClass = SizeClass;
+  Slab->NumLive = 0;
+  Slab->NumSlots = Convert<uint32>((Heap_SlabSize - FirstSlotOffset) / HeapSlotSize(SizeClass));
+  return Slab;
+}
+
+/// Take a free slot of the given size class from a slab.
+///
+/// \return \c nullptr if no slab with a free slot could be acquired.
+static void*
+HeapAllocateSlot(heap* Heap, uint32 SizeClass)
+{
+  auto Slab = Heap->PartialSlabs[SizeClass];
+  if(Slab == nullptr)
+  {
+    Slab = HeapAcquireSlab(Heap, SizeClass);
+    if(Slab == nullptr)
+      return nullptr;
+
+    HeapListPush(&Heap->PartialSlabs[SizeClass], Slab);
+  }
+
+  void* Ptr = Slab->FreeList;
+  if(Ptr)
+  {
+    Slab->FreeList = *Reinterpret<void**>(Ptr);
+  }
+  else
+  {
+    Ptr = Slab->Unused;
+    Slab->Unused += HeapSlotSize(SizeClass);
+  }
+
+  ++Slab->NumLive;
+  if(Slab->NumLive == Slab->NumSlots)
+    HeapListRemove(&Heap->PartialSlabs[SizeClass], Slab);
+
+  return Ptr;
+}
+
+static bool
+HeapOwnsSlot(heap const& Heap, void* Ptr)
+{
+  auto const Address = Reinterpret<size_t>(Ptr);
+  auto const Begin = Reinterpret<size_t>(Heap.Slabs.Memory.Ptr);
+  return Address >= Begin && Address - Begin < Heap.Slabs.Memory.Num;
+}
+
+static void*
+HeapAllocateLarge(memory_size Size, size_t Alignment)
+{
+  Alignment = Max(Alignment, alignof(heap_large_header));
+  auto const TotalSize = ToBytes(Size) + sizeof(heap_large_header) + Alignment - 1;
+  auto Base = std::malloc(Convert<size_t>(TotalSize));
+  if(Base == nullptr)
+    return nullptr;
+
+  auto const Begin = Reinterpret<size_t>(Base) + sizeof(heap_large_header);
+  auto const Ptr = Reinterpret<void*>(AlignUp(Begin, Alignment));
+  auto Header = Reinterpret<heap_large_header*>(Ptr) - 1;
+  Header->Base = Base;
+  Header->Size = Convert<size_t>(ToBytes(Size));
+  return Ptr;
+}
+
+static memory_size
+HeapLargeSize(void* Ptr)
+{
+  auto Header = Reinterpret<heap_large_header*>(Ptr) - 1;
+  return Bytes(Header->Size);
+}
+
+static void
+HeapFreeLarge(void* Ptr)
+{
+  auto Header = Reinterpret<heap_large_header*>(Ptr) - 1;
+  std::free(Header->Base);
+}
+
+auto
+::HeapInit(heap* Heap, memory_size ReserveSize)
+  -> void
+{
+  Assert(Heap);
+  *Heap = {};
+
+  // Restricted address spaces (e.g. ulimit -v) may not allow reserving that
+  // much, so settle for less. If not even a single slab fits, all
+  // allocations go through HeapAllocateLarge.
+  auto Reserve = ToBytes(ReserveSize);
+  while(Reserve >= Heap_SlabSize)
+  {
+    ArenaInitVirtual(&Heap->Slabs, Bytes(Reserve));
+    if(Heap->Slabs.Memory.Ptr)
+      break;
+    Reserve /= 2;
+  }
+}
+
+auto
+::HeapFinalize(heap* Heap)
+  -> void
+{
+  Assert(Heap);
+  ArenaFinalize(&Heap->Slabs);
+  *Heap = {};
+}
+
+auto
+::HeapAllocate(heap* Heap, memory_size Size, size_t Alignment)
+  -> void*
+{
+  Assert(Heap);
+  Assert(IsPowerOfTwo(Alignment));
+
+  // Slots are aligned to their own size, so a big alignment simply
+  // requires a big enough slot.
+  auto const SlotSize = Max(Max(ToBytes(Size), uint64(1)), uint64(Alignment));
+  if(SlotSize > Heap_MaxSmallSize)
+  {
+    auto Ptr = HeapAllocateLarge(Size, Alignment);
+    if(Ptr)
+      AllocStatsRecordAllocation(Heap->Stats, Size);
+    return Ptr;
+  }
+
+  auto const SizeClass = HeapSizeClass(SlotSize);
+  if(auto Ptr = HeapAllocateSlot(Heap, SizeClass))
+  {
+    AllocStatsRecordAllocation(Heap->Stats, Bytes(HeapSlotSize(SizeClass)));
+    return Ptr;
+  }
+
+  // Out of address space for slabs. HeapFree tells the two kinds apart by
+  // address, so a large block works just as well.
+  auto Ptr = HeapAllocateLarge(Size, Alignment);
+  if(Ptr)
+    AllocStatsRecordAllocation(Heap->Stats, Size);
+  return Ptr;
+}
+
+auto
+::HeapFree(heap* Heap, void* Ptr)
+  -> void
+{
+  Assert(Heap);
+  if(Ptr == nullptr)
+    return;
+
+  if(!HeapOwnsSlot(*Heap, Ptr))
+  {
+    AllocStatsRecordFree(Heap->Stats, HeapLargeSize(Ptr));
+    HeapFreeLarge(Ptr);
+    return;
+  }
+
+  auto Slab = HeapSlabOf(Ptr);
+  Assert(Slab->NumLive > 0);
+  AllocStatsRecordFree(Heap->Stats, Bytes(HeapSlotSize(Slab->SizeClass)));
+
+  *Reinterpret<void**>(Ptr) = Slab->FreeList;
+  Slab->FreeList = Ptr;
+
+  auto const WasFull = Slab->NumLive == Slab->NumSlots;
+  --Slab->NumLive;
+
+  if(Slab->NumLive == 0)
+  {
+    // Full slabs are not in any list.
+    if(!WasFull)
+      HeapListRemove(&Heap->PartialSlabs[Slab->SizeClass], Slab);
+
+    Slab->Next = Heap->EmptySlabs;
+    Heap->EmptySlabs = Slab;
+  }
+  else if(WasFull)
+  {
+    HeapListPush(&Heap->PartialSlabs[Slab->SizeClass], Slab);
+  }
+}
+
+static void*
+HeapAllocatorAllocate(void* Context, memory_size Size, size_t Alignment)
+{
+  return HeapAllocate(Reinterpret<heap*>(Context), Size, Alignment);
+}
+
+static void
+HeapAllocatorFree(void* Context, void* Ptr, memory_size Size)
+{
+  HeapFree(Reinterpret<heap*>(Context), Ptr);
+}
+
+auto
+::AllocatorFrom(heap* Heap)
+  -> allocator
+{
+  allocator Result;
+  Result.Context = Heap;
+  Result.AllocateFunc = HeapAllocatorAllocate;
+  Result.ReallocateFunc = nullptr;
+  Result.FreeFunc = HeapAllocatorFree;
+  return Result;
+}
+
+
+//
+// Process-wide heap
+//
+
+static std::mutex GlobalHeapMutex;
+
+/// Set with MemSetStats.
+///
+/// Read by every MemAllocate and MemFree, so keep it away from the mutex.
+static cache_line_padded<std::atomic<allocation_stats*>> GlobalMemStats{ { nullptr } };
+
+/// The process-wide heap, initialized on first use.
+///
+/// Lock GlobalHeapMutex before modifying it.
+static heap*
+GlobalHeap()
+{
+  struct global_heap
+  {
+    heap Heap;
+    global_heap() { HeapInit(&Heap); }
+  };
+
+  static global_heap Instance;
+  return &Instance.Heap;
+}
+
+/// A per-thread stack of free slots ("magazine") for each size class.
+///
+/// Allocations and frees of small blocks only touch the cache of the calling
+/// thread. Only when a magazine runs empty or full, a batch of slots is
+/// transferred from or to the global heap, which is when the lock is taken.
+struct heap_thread_cache;
+
+static void
+HeapFlushThreadCache(heap_thread_cache* Cache);
+
+struct heap_thread_cache
+{
+  void* Slots[Heap_NumSizeClasses][Heap_ThreadCacheCapacity];
+  uint32 Num[Heap_NumSizeClasses];
+
+  /// Give all cached slots back when the thread exits.
+  ~heap_thread_cache() { HeapFlushThreadCache(this); }
+};
+
+static thread_local heap_thread_cache ThreadCache;
+
+static void
+HeapFlushThreadCache(heap_thread_cache* Cache)
+{
+  std::lock_guard<std::mutex> Lock(GlobalHeapMutex);
+  for(uint32 SizeClass = 0; SizeClass < Heap_NumSizeClasses; ++SizeClass)
+  {
+    for(uint32 Index = 0; Index < Cache->Num[SizeClass]; ++Index)
+      HeapFree(GlobalHeap(), Cache->Slots[SizeClass][Index]);
+    Cache->Num[SizeClass] = 0;
+  }
+}
+
+/// Fill the magazine of the given size class with a batch of fresh slots.
+static bool
+HeapRefillThreadCache(heap_thread_cache* Cache, uint32 SizeClass)
+{
+  std::lock_guard<std::mutex> Lock(GlobalHeapMutex);
+
+  while(Cache->Num[SizeClass] < Heap_ThreadCacheBatchSize)
+  {
+    auto Ptr = HeapAllocateSlot(GlobalHeap(), SizeClass);
+    if(Ptr == nullptr)
+      break;
+    Cache->Slots[SizeClass][Cache->Num[SizeClass]++] = Ptr;
+  }
+
+  return Cache->Num[SizeClass] > 0;
+}
+
+/// Return a batch of slots of the given size class to the global heap.
+static void
+HeapDrainThreadCache(heap_thread_cache* Cache, uint32 SizeClass)
+{
+  std::lock_guard<std::mutex> Lock(GlobalHeapMutex);
+
+  auto const NumToKeep = Heap_ThreadCacheCapacity - Heap_ThreadCacheBatchSize;
+  while(Cache->Num[SizeClass] > NumToKeep)
+    HeapFree(GlobalHeap(), Cache->Slots[SizeClass][--Cache->Num[SizeClass]]);
+}
+
+auto
+::MemAllocate(memory_size Size, size_t Alignment)
+  -> void*
+{
+  Assert(IsPowerOfTwo(Alignment));
+
+  auto Stats = GlobalMemStats.Value.load(std::memory_order_relaxed);
+
+  auto const SlotSize = Max(Max(ToBytes(Size), uint64(1)), uint64(Alignment));
+  if(SlotSize <= Heap_MaxSmallSize)
+  {
+    auto const SizeClass = HeapSizeClass(SlotSize);
+    auto Cache = &ThreadCache;
+    if(Cache->Num[SizeClass] > 0 || HeapRefillThreadCache(Cache, SizeClass))
+    {
+      AllocStatsRecordAllocation(Stats, Bytes(HeapSlotSize(SizeClass)));
+      return Cache->Slots[SizeClass][--Cache->Num[SizeClass]];
+    }
+
+    // Out of address space for slabs, see HeapAllocate.
+  }
+
+  auto Ptr = HeapAllocateLarge(Size, Alignment);
+  if(Ptr)
+    AllocStatsRecordAllocation(Stats, Size);
+  return Ptr;
+}
+
+auto
+::MemFree(void* Ptr)
+  -> void
+{
+  if(Ptr == nullptr)
+    return;
+
+  auto Stats = GlobalMemStats.Value.load(std::memory_order_relaxed);
+
+  if(!HeapOwnsSlot(*GlobalHeap(), Ptr))
+  {
+    AllocStatsRecordFree(Stats, HeapLargeSize(Ptr));
+    HeapFreeLarge(Ptr);
+    return;
+  }
+
+  // The size class of a slab only changes after all of its slots were
+  // freed, so it is safe to read without holding the lock.
+  auto const SizeClass = HeapSlabOf(Ptr)->SizeClass;
+  AllocStatsRecordFree(Stats, Bytes(HeapSlotSize(SizeClass)));
+  auto Cache = &ThreadCache;
+  if(Cache->Num[SizeClass] == Heap_ThreadCacheCapacity)
+    HeapDrainThreadCache(Cache, SizeClass);
+
+  Cache->Slots[SizeClass][Cache->Num[SizeClass]++] = Ptr;
+}
+
+auto
+::MemFlushThreadCache()
+  -> void
+{
+  HeapFlushThreadCache(&ThreadCache);
+}
+
+auto
+::MemSetStats(allocation_stats* Stats)
+  -> void
+{
+  GlobalMemStats.Value.store(Stats, std::memory_order_relaxed);
+}
+
+static void*
+DefaultAllocatorAllocate(void* Context, memory_size Size, size_t Alignment)
+{
+  return MemAllocate(Size, Alignment);
+}
+
+static void
+DefaultAllocatorFree(void* Context, void* Ptr, memory_size Size)
+{
+  MemFree(Ptr);
+}
+
+auto
+::DefaultAllocator()
+  -> allocator
+{
+  allocator Result;
+  Result.Context = nullptr;
+  Result.AllocateFunc = DefaultAllocatorAllocate;
+  Result.ReallocateFunc = nullptr;
+  Result.FreeFunc = DefaultAllocatorFree;
+  return Result;
+}
+
+//]]~~
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Arena.hpp"
+#include "Allocator.hpp"
+#include "AllocationStats.hpp"
+
+//~~[[
+
+RESERVE_PREFIX(Heap);
+
+enum
+{
+  /// Allocations up to this size are served from slabs, everything bigger
+  /// goes straight to the system allocator.
+  Heap_MaxSmallSize = 1024,
+
+  /// Size classes are the powers of two from 16 to Heap_MaxSmallSize bytes.
+  Heap_NumSizeClasses = 7,
+
+  /// Slabs are carved out of the heap's address space with this size.
+  Heap_SlabSize = 64 * 1024,
+
+  /// The maximum number of free slots per size class each thread keeps in
+  /// its cache for MemAllocate.
+  Heap_ThreadCacheCapacity = 64,
+
+  /// The number of slots that are moved between a thread cache and the
+  /// process-wide heap at once.
+  Heap_ThreadCacheBatchSize = 32,
+};
+
+struct heap_slab;
+
+/// A general purpose allocator optimized for small allocations.
+///
+/// Small allocations are rounded up to the next power of two and served from
+/// slabs, which are 64 KiB chunks that only contain slots of a single size
+/// class. Freed slots are kept on an intrusive free list per slab. Slabs that
+/// become completely empty can be reused for any size class. Allocating and
+/// freeing small blocks is O(1).
+///
+/// A heap is not thread-safe on its own.
+///
+/// \see MemAllocate
+struct heap
+{
+  /// Address space all slabs are carved from.
+  arena Slabs;
+
+  /// Per size class, a doubly linked list of slabs that have at least one
+  /// free slot.
+  heap_slab* PartialSlabs[Heap_NumSizeClasses];
+
+  /// Singly linked list of slabs without any live allocations.
+  heap_slab* EmptySlabs;
+
+  /// Where to record allocations. May be \c nullptr.
+  ///
+  /// Small allocations are recorded with the size of their slot.
+  ///
+  /// \see allocation_stats
+  allocation_stats* Stats;
+};
+
+/// \param ReserveSize The amount of address space reserved for slabs. This
+///                    limits the total amount of memory that can be used for
+///                    small allocations. If that much can't be reserved, less
+///                    is used. Small allocations that don't fit into slabs
+///                    are served like large ones.
+void
+HeapInit(heap* Heap, memory_size ReserveSize = GiB(64));
+
+/// Release all memory of the heap.
+///
+/// Allocations bigger than Heap_MaxSmallSize that were not freed yet are
+/// leaked.
+void
+HeapFinalize(heap* Heap);
+
+/// Allocate Size bytes with the given Alignment.
+///
+/// The memory is not initialized.
+///
+/// \param Alignment Must be a power of two.
+/// \return \c nullptr if out of memory.
+void*
+HeapAllocate(heap* Heap, memory_size Size, size_t Alignment);
+
+/// Free memory previously allocated with HeapAllocate from the same Heap.
+///
+/// \param Ptr May be \c nullptr.
+void
+HeapFree(heap* Heap, void* Ptr);
+
+/// Get an allocator that allocates from the given heap.
+allocator
+AllocatorFrom(heap* Heap);
+
+
+/// Allocate Size bytes with the given Alignment from the process-wide heap.
+///
+/// Like malloc but with an explicit alignment. Unlike the heap functions
+/// above, this is thread-safe.
+///
+/// Small allocations are served from a per-thread cache. The process-wide
+/// heap is only locked when that cache needs to be refilled or drained, which
+/// happens in batches of Heap_ThreadCacheBatchSize slots.
+///
+/// \param Alignment Must be a power of two.
+/// \return \c nullptr if out of memory.
+void*
+MemAllocate(memory_size Size, size_t Alignment = 16);
+
+/// Free memory allocated with MemAllocate.
+///
+/// \param Ptr May be \c nullptr.
+void
+MemFree(void* Ptr);
+
+/// Return all slots cached by the calling thread to the process-wide heap.
+///
+/// This happens automatically when a thread exits.
+void
+MemFlushThreadCache();
+
+/// Start recording allocations of MemAllocate and MemFree in Stats.
+///
+/// Should be called before the first allocation, otherwise frees of memory
+/// that was allocated earlier are recorded as well.
+///
+/// \param Stats May be \c nullptr to stop recording.
+void
+MemSetStats(allocation_stats* Stats);
+
+/// Get an allocator that allocates from the process-wide heap.
+///
+/// \see MemAllocate
+allocator
+DefaultAllocator();
+
+//]]~~
@@ -0,0 +1,165 @@
+#include "MappedFile.hpp"
+#include "Memory.hpp"
+#include "VirtualMemory.hpp"
+
+#if defined(BB_Platform_Windows)
+  #include <windows.h>
+#elif defined(BB_Platform_Linux)
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+//~~[[
+
+/// Copy Path into Buffer and append a null terminator for the OS.
+static bool
+MapFileTerminatePath(slice<char const> Path, char (&Buffer)[MapFile_MaxPathLength])
+{
+  if(Path.Num >= MapFile_MaxPathLength)
+    return false;
+
+  MemCopyBytes(Bytes(Path.Num), Buffer, Path.Ptr);
+  Buffer[Path.Num] = '\0';
+  return true;
+}
+
+#if defined(BB_Platform_Windows)
+
+auto
+::MapFile(slice<char const> Path, map_file_access Access)
+  -> slice<uint8 const>
+{
+  char TerminatedPath[MapFile_MaxPathLength];
+  if(!MapFileTerminatePath(Path, TerminatedPath))
+    return {};
+
+  DWORD Flags = FILE_ATTRIBUTE_NORMAL;
+  if(Access == MapFile_SequentialAccess) Flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+  if(Access == MapFile_RandomAccess)     Flags |= FILE_FLAG_RANDOM_ACCESS;
+
+  auto File = CreateFileA(TerminatedPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, Flags, nullptr);
+  if(File == INVALID_HANDLE_VALUE)
+    return {};
+  Defer [=](){ CloseHandle(File); };
+
+  LARGE_INTEGER FileSize;
+  if(!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart <= 0 || uint64(FileSize.QuadPart) > IntMaxValue<size_t>())
+    return {};
+
+  // The view keeps the mapping and the file alive, so both handles can be
+  // closed right away.
+  auto Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if(Mapping == nullptr)
+    return {};
+  Defer [=](){ CloseHandle(Mapping); };
+
+  auto Ptr = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+  if(Ptr == nullptr)
+    return {};
+
+  auto Result = Slice(Convert<size_t>(FileSize.QuadPart), Reinterpret<uint8 const*>(Ptr));
+  if(Access == MapFile_WillNeed)
+    MapFileAdvise(Result, Access);
+  return Result;
+}
+
+auto
+::MapFileAdvise(slice<uint8 const> Range, map_file_access Access)
+  -> void
+{
+  if(Range.Num == 0)
+    return;
+
+  // Read-ahead of mapped views is decided when the file is opened. Only
+  // prefetching can be requested later on.
+#if _WIN32_WINNT >= 0x0602
+  if(Access == MapFile_WillNeed)
+  {
+    WIN32_MEMORY_RANGE_ENTRY Entry;
+    Entry.VirtualAddress = Coerce<void*>(Range.Ptr);
+    Entry.NumberOfBytes = Range.Num;
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &Entry, 0);
+  }
+#endif
+}
+
+auto
+::UnmapFile(slice<uint8 const> File)
+  -> void
+{
+  if(File.Num == 0)
+    return;
+
+  UnmapViewOfFile(File.Ptr);
+}
+
+#elif defined(BB_Platform_Linux)
+
+auto
+::MapFile(slice<char const> Path, map_file_access Access)
+  -> slice<uint8 const>
+{
+  char TerminatedPath[MapFile_MaxPathLength];
+  if(!MapFileTerminatePath(Path, TerminatedPath))
+    return {};
+
+  auto const File = open(TerminatedPath, O_RDONLY | O_CLOEXEC);
+  if(File < 0)
+    return {};
+  Defer [=](){ close(File); };
+
+  struct stat FileStatus;
+  if(fstat(File, &FileStatus) != 0 || FileStatus.st_size <= 0 || uint64(FileStatus.st_size) > IntMaxValue<size_t>())
+    return {};
+
+  // The mapping keeps the file alive, so it can be closed right away.
+  auto const Size = Convert<size_t>(FileStatus.st_size);
+  auto Ptr = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, File, 0);
+  if(Ptr == MAP_FAILED)
+    return {};
+
+  auto Result = Slice(Size, Reinterpret<uint8 const*>(Ptr));
+  if(Access != MapFile_NormalAccess)
+    MapFileAdvise(Result, Access);
+  return Result;
+}
+
+auto
+::MapFileAdvise(slice<uint8 const> Range, map_file_access Access)
+  -> void
+{
+  if(Range.Num == 0)
+    return;
+
+  int Advice = MADV_NORMAL;
+  switch(Access)
+  {
+    case MapFile_NormalAccess:     Advice = MADV_NORMAL;     break;
+    case MapFile_SequentialAccess: Advice = MADV_SEQUENTIAL; break;
+    case MapFile_RandomAccess:     Advice = MADV_RANDOM;     break;
+    case MapFile_WillNeed:         Advice = MADV_WILLNEED;   break;
+    case MapFile_DontNeed:         Advice = MADV_DONTNEED;   break;
+  }
+
+  // madvise wants a page aligned address.
+  auto const PageSize = Convert<size_t>(ToBytes(VirtualMemPageSize()));
+  auto const Begin = AlignDown(Reinterpret<size_t>(Range.Ptr), PageSize);
+  auto const End = Reinterpret<size_t>(Range.Ptr) + Range.Num;
+  madvise(Reinterpret<void*>(Begin), End - Begin, Advice);
+}
+
+auto
+::UnmapFile(slice<uint8 const> File)
+  -> void
+{
+  if(File.Num == 0)
+    return;
+
+  munmap(Coerce<void*>(File.Ptr), File.Num);
+}
+
+#endif
+
+//]]~~
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Slice.hpp"
+
+//~~[[
+
+/// \defgroup Memory-mapped files
+///
+/// Read-only views of whole files, backed by the virtual memory system of
+/// the OS. Pages are read from disk when they are first touched, so mapping
+/// a multi-GB file is cheap and nothing is copied.
+///
+/// Usage:
+/// \code
+/// auto File = MapFile("Data.csv"_S, MapFile_SequentialAccess);
+/// Defer [&](){ UnmapFile(File); };
+///
+/// auto Text = SliceReinterpret<char const>(File);
+/// auto FirstLineLength = SliceCountUntil(Text, '\n');
+/// \endcode
+///
+/// @{
+
+RESERVE_PREFIX(MapFile);
+
+enum
+{
+  /// Paths must be shorter than this.
+  MapFile_MaxPathLength = 4096,
+};
+
+/// How a mapped file is going to be accessed. Lets the OS pick a fitting
+/// read-ahead strategy (Linux: madvise).
+enum map_file_access
+{
+  /// No particular pattern.
+  MapFile_NormalAccess,
+
+  /// Front to back. Read ahead aggressively, drop pages soon after use.
+  MapFile_SequentialAccess,
+
+  /// Random positions. Don't read ahead.
+  MapFile_RandomAccess,
+
+  /// The range will be used soon. Start reading it in now.
+  MapFile_WillNeed,
+
+  /// The range won't be used for a while. Its pages may be dropped, they are
+  /// read again from the file when touched.
+  MapFile_DontNeed,
+};
+
+/// Map the whole file at Path into memory for reading.
+///
+/// The file can't be written through the returned slice. Changes others
+/// make to the file while it is mapped may or may not be visible.
+///
+/// \param Path Doesn't need to be null-terminated.
+/// \return An empty slice if the file could not be opened, or if it is empty.
+slice<uint8 const>
+MapFile(slice<char const> Path, map_file_access Access = MapFile_NormalAccess);
+
+/// Tell the OS how the given part of a mapped file is going to be used.
+///
+/// \param Range Any part of a slice returned by MapFile.
+void
+MapFileAdvise(slice<uint8 const> Range, map_file_access Access);
+
+/// Unmap a file mapped with MapFile.
+///
+/// \param File Exactly the slice that was returned by MapFile. Empty slices
+///             are ignored.
+void
+UnmapFile(slice<uint8 const> File);
+
+/// @}
+
+//]]~~
@@ -1,37 +1,684 @@
 #include "Memory.hpp"
+#include "Slice.hpp"
 
 #include <cstring>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(BB_Platform_x64)
+  #include <immintrin.h>
+#endif
 
 
 //~~[[
 
+#if defined(BB_Platform_x64)
+
+// The streaming kernels expect Destination to be aligned to the vector width
+// and NumBytes to be a multiple of Mem_StreamBlockSize.
+
+enum { Mem_StreamBlockSize = 128 };
+
+BB_TargetFeatures("avx")
+static void
+MemStreamCopyAVX(size_t NumBytes, uint8* Destination, uint8 const* Source)
+{
+  for(size_t Offset = 0; Offset < NumBytes; Offset += Mem_StreamBlockSize)
+  {
+    auto const From = Reinterpret<__m256i const*>(Source + Offset);
+    auto const To = Reinterpret<__m256i*>(Destination + Offset);
+    auto const A = _mm256_loadu_si256(From + 0);
+    auto const B = _mm256_loadu_si256(From + 1);
+    auto const C = _mm256_loadu_si256(From + 2);
+    auto const D = _mm256_loadu_si256(From + 3);
+    _mm256_stream_si256(To + 0, A);
+    _mm256_stream_si256(To + 1, B);
+    _mm256_stream_si256(To + 2, C);
+    _mm256_stream_si256(To + 3, D);
+  }
+}
+
+static void
+MemStreamCopySSE2(size_t NumBytes, uint8* Destination, uint8 const* Source)
+{
+  for(size_t Offset = 0; Offset < NumBytes; Offset += Mem_StreamBlockSize)
+  {
+    auto const From = Reinterpret<__m128i const*>(Source + Offset);
+    auto const To = Reinterpret<__m128i*>(Destination + Offset);
+    for(int Index = 0; Index < 8; Index += 4)
+    {
+      auto const A = _mm_loadu_si128(From + Index + 0);
+      auto const B = _mm_loadu_si128(From + Index + 1);
+      auto const C = _mm_loadu_si128(From + Index + 2);
+      auto const D = _mm_loadu_si128(From + Index + 3);
+      _mm_stream_si128(To + Index + 0, A);
+      _mm_stream_si128(To + Index + 1, B);
+      _mm_stream_si128(To + Index + 2, C);
+      _mm_stream_si128(To + Index + 3, D);
+    }
+  }
+}
+
+BB_TargetFeatures("avx")
+static void
+MemStreamSetAVX(size_t NumBytes, uint8* Destination, uint8 Value)
+{
+  auto const Pattern = _mm256_set1_epi8(char(Value));
+  for(size_t Offset = 0; Offset < NumBytes; Offset += Mem_StreamBlockSize)
+  {
+    auto const To = Reinterpret<__m256i*>(Destination + Offset);
+    _mm256_stream_si256(To + 0, Pattern);
+    _mm256_stream_si256(To + 1, Pattern);
+    _mm256_stream_si256(To + 2, Pattern);
+    _mm256_stream_si256(To + 3, Pattern);
+  }
+}
+
+static void
+MemStreamSetSSE2(size_t NumBytes, uint8* Destination, uint8 Value)
+{
+  auto const Pattern = _mm_set1_epi8(char(Value));
+  for(size_t Offset = 0; Offset < NumBytes; Offset += Mem_StreamBlockSize)
+  {
+    auto const To = Reinterpret<__m128i*>(Destination + Offset);
+    for(int Index = 0; Index < 8; ++Index)
+      _mm_stream_si128(To + Index, Pattern);
+  }
+}
+
+#endif
+
+/// Number of bytes to copy or set in front of Destination until it is
+/// aligned to Alignment.
+static size_t
+MemNumBytesUntilAligned(size_t NumBytes, void const* Destination, size_t Alignment)
+{
+  auto const Address = Reinterpret<size_t>(Destination);
+  return Min(NumBytes, AlignUp(Address, Alignment) - Address);
+}
+
 auto
 ::MemCopyBytes(memory_size Size, void* Destination, void const* Source)
   -> void
 {
-  // Using memmove so that Destination and Source may overlap.
-  std::memmove(Destination, Source, ToBytes(Size));
+  if(MemAreOverlapping(Size, Destination, Size, Source))
+  {
+    // Using memmove so that Destination and Source may overlap.
+    std::memmove(Destination, Source, ToBytes(Size));
+  }
+  else
+  {
+    MemCopyBytesNonOverlapping(Size, Destination, Source);
+  }
+}
+
+auto
+::MemCopyBytesNonOverlapping(memory_size Size, void* Destination, void const* Source)
+  -> void
+{
+  Assert(!MemAreOverlapping(Size, Destination, Size, Source));
+
+  if(Size >= Bytes(Mem_NonTemporalThreshold))
+    MemCopyBytesNonTemporal(Size, Destination, Source);
+  else
+    std::memcpy(Destination, Source, ToBytes(Size));
+}
+
+auto
+::MemCopyBytesNonTemporal(memory_size Size, void* Destination, void const* Source)
+  -> void
+{
+  Assert(!MemAreOverlapping(Size, Destination, Size, Source));
+
+#if defined(BB_Platform_x64)
+  auto To = Reinterpret<uint8*>(Destination);
+  auto From = Reinterpret<uint8 const*>(Source);
+  size_t NumBytes = ToBytes(Size);
+
+  // Copy the unaligned head and the tail the regular way.
+  auto const NumHeadBytes = MemNumBytesUntilAligned(NumBytes, To, 32);
+  std::memcpy(To, From, NumHeadBytes);
+  To += NumHeadBytes;
+  From += NumHeadBytes;
+  NumBytes -= NumHeadBytes;
+
+  auto const NumBodyBytes = AlignDown(NumBytes, Mem_StreamBlockSize);
+  if(CpuHasFeature(Cpu_AVX))
+    MemStreamCopyAVX(NumBodyBytes, To, From);
+  else
+    MemStreamCopySSE2(NumBodyBytes, To, From);
+
+  // Non-temporal stores are weakly ordered.
+  _mm_sfence();
+
+  std::memcpy(To + NumBodyBytes, From + NumBodyBytes, NumBytes - NumBodyBytes);
+#else
+  std::memcpy(Destination, Source, ToBytes(Size));
+#endif
+}
+
+/// Copy up to 64 bytes with a few fixed-size moves. The moves may overlap
+/// each other, the bytes they write are the same.
+static void
+MemCopySmall(size_t NumBytes, uint8* To, uint8 const* From)
+{
+  if(NumBytes >= 32)
+  {
+    // 32 to 64 bytes.
+    std::memcpy(To, From, 32);
+    std::memcpy(To + NumBytes - 32, From + NumBytes - 32, 32);
+  }
+  else if(NumBytes >= 16)
+  {
+    std::memcpy(To, From, 16);
+    std::memcpy(To + NumBytes - 16, From + NumBytes - 16, 16);
+  }
+  else if(NumBytes >= 8)
+  {
+    std::memcpy(To, From, 8);
+    std::memcpy(To + NumBytes - 8, From + NumBytes - 8, 8);
+  }
+  else if(NumBytes >= 4)
+  {
+    std::memcpy(To, From, 4);
+    std::memcpy(To + NumBytes - 4, From + NumBytes - 4, 4);
+  }
+  else if(NumBytes > 0)
+  {
+    // 1 to 3 bytes.
+    To[0] = From[0];
+    To[NumBytes / 2] = From[NumBytes / 2];
+    To[NumBytes - 1] = From[NumBytes - 1];
+  }
+}
+
+auto
+::MemCopyBatch(slice<mem_copy_op const> Ops)
+  -> void
+{
+  // How many copies ahead to prefetch the source.
+  size_t const PrefetchDistance = 8;
+
+  for(size_t Index = 0; Index < Ops.Num; ++Index)
+  {
+  #if defined(BB_Platform_x64)
+    if(Index + PrefetchDistance < Ops.Num)
+      _mm_prefetch(Reinterpret<char const*>(Ops.Ptr[Index + PrefetchDistance].Source), _MM_HINT_T0);
+  #endif
+
+    auto const& Op = Ops.Ptr[Index];
+    Assert(!MemAreOverlapping(Op.Size, Op.Destination, Op.Size, Op.Source));
+
+    auto const NumBytes = Convert<size_t>(ToBytes(Op.Size));
+    if(NumBytes <= 64)
+      MemCopySmall(NumBytes, Reinterpret<uint8*>(Op.Destination), Reinterpret<uint8 const*>(Op.Source));
+    else
+      std::memcpy(Op.Destination, Op.Source, NumBytes);
+  }
+}
+
+/// A parallel copy, split into chunks that threads claim one after another.
+struct mem_parallel_copy
+{
+  uint8* Destination;
+  uint8 const* Source;
+  size_t NumBytes;
+  size_t ChunkSize;
+  size_t NumChunks;
+  std::atomic<size_t> NextChunk;
+  std::atomic<size_t> NumChunksDone;
+};
+
+static void
+MemParallelCopyRun(mem_parallel_copy* Copy)
+{
+  while(true)
+  {
+    auto const Chunk = Copy->NextChunk.fetch_add(1, std::memory_order_relaxed);
+    if(Chunk >= Copy->NumChunks)
+      break;
+
+    auto const Offset = Chunk * Copy->ChunkSize;
+    auto const NumBytes = Min(Copy->ChunkSize, Copy->NumBytes - Offset);
+    MemCopyBytesNonOverlapping(Bytes(NumBytes), Copy->Destination + Offset, Copy->Source + Offset);
+    Copy->NumChunksDone.fetch_add(1, std::memory_order_release);
+  }
+}
+
+/// The worker threads for MemCopyBytesParallel.
+struct mem_parallel_copy_pool;
+
+static void
+MemParallelCopyPoolStart(mem_parallel_copy_pool* Pool);
+
+static void
+MemParallelCopyPoolStop(mem_parallel_copy_pool* Pool);
+
+struct mem_parallel_copy_pool
+{
+  /// Held by the thread that is using the pool.
+  std::mutex CallerMutex;
+
+  /// Guards everything below.
+  std::mutex Mutex;
+  std::condition_variable WakeUp;
+  std::condition_variable WorkersIdle;
+
+  mem_parallel_copy* Copy = nullptr;
+  uint64 Generation = 0;
+  uint32 NumBusyWorkers = 0;
+  bool ShouldStop = false;
+
+  std::thread* Workers = nullptr;
+  uint32 NumWorkers = 0;
+
+  mem_parallel_copy_pool() { MemParallelCopyPoolStart(this); }
+  ~mem_parallel_copy_pool() { MemParallelCopyPoolStop(this); }
+};
+
+static void
+MemParallelCopyWork(mem_parallel_copy_pool* Pool)
+{
+  uint64 SeenGeneration = 0;
+  std::unique_lock<std::mutex> Lock(Pool->Mutex);
+  while(true)
+  {
+    Pool->WakeUp.wait(Lock, [&](){ return Pool->ShouldStop || Pool->Generation != SeenGeneration; });
+    if(Pool->ShouldStop)
+      return;
+
+    SeenGeneration = Pool->Generation;
+
+    // Woke up too late, the copy is done already.
+    if(Pool->Copy == nullptr)
+      continue;
+
+    auto const Copy = Pool->Copy;
+    ++Pool->NumBusyWorkers;
+    Lock.unlock();
+    MemParallelCopyRun(Copy);
+    Lock.lock();
+    if(--Pool->NumBusyWorkers == 0)
+      Pool->WorkersIdle.notify_all();
+  }
+}
+
+static void
+MemParallelCopyPoolStart(mem_parallel_copy_pool* Pool)
+{
+  // The calling thread does its share of the work, too.
+  auto const NumHardwareThreads = Max(std::thread::hardware_concurrency(), 1u);
+  Pool->NumWorkers = NumHardwareThreads - 1;
+  Pool->Workers = new std::thread[Pool->NumWorkers];
+  for(uint32 Index = 0; Index < Pool->NumWorkers; ++Index)
+    Pool->Workers[Index] = std::thread(MemParallelCopyWork, Pool);
+}
+
+static void
+MemParallelCopyPoolStop(mem_parallel_copy_pool* Pool)
+{
+  {
+    std::lock_guard<std::mutex> Lock(Pool->Mutex);
+    Pool->ShouldStop = true;
+  }
+  Pool->WakeUp.notify_all();
+  for(uint32 Index = 0; Index < Pool->NumWorkers; ++Index)
+    Pool->Workers[Index].join();
+  delete[] Pool->Workers;
+}
+
+auto
+::MemCopyBytesParallel(memory_size Size, void* Destination, void const* Source)
+  -> void
+{
+  Assert(!MemAreOverlapping(Size, Destination, Size, Source));
+
+  auto const NumBytes = Convert<size_t>(ToBytes(Size));
+  if(NumBytes < Mem_ParallelCopyThreshold)
+  {
+    MemCopyBytesNonOverlapping(Size, Destination, Source);
+    return;
+  }
+
+  static mem_parallel_copy_pool Pool;
+  if(Pool.NumWorkers == 0)
+  {
+    MemCopyBytesNonOverlapping(Size, Destination, Source);
+    return;
+  }
+
+  std::lock_guard<std::mutex> CallerLock(Pool.CallerMutex);
+
+  // A few chunks per thread so that threads that get delayed don't hold up
+  // the others. Chunk boundaries fall on page boundaries of Destination.
+  size_t const PageSize = 4096;
+  auto const NumThreads = Pool.NumWorkers + 1;
+  auto const Head = Reinterpret<uint8*>(Destination);
+  auto const HeadSize = AlignUp(Reinterpret<size_t>(Head), PageSize) - Reinterpret<size_t>(Head);
+
+  mem_parallel_copy Copy;
+  Copy.Destination = Head + HeadSize;
+  Copy.Source = Reinterpret<uint8 const*>(Source) + HeadSize;
+  Copy.NumBytes = NumBytes - HeadSize;
+  Copy.ChunkSize = Max(AlignUp(Copy.NumBytes / (4 * NumThreads), PageSize), PageSize);
+  Copy.NumChunks = (Copy.NumBytes + Copy.ChunkSize - 1) / Copy.ChunkSize;
+  Copy.NextChunk = 0;
+  Copy.NumChunksDone = 0;
+
+  {
+    std::lock_guard<std::mutex> Lock(Pool.Mutex);
+    Pool.Copy = &Copy;
+    ++Pool.Generation;
+  }
+  Pool.WakeUp.notify_all();
+
+  MemCopyBytesNonOverlapping(Bytes(HeadSize), Head, Source);
+  MemParallelCopyRun(&Copy);
+
+  // Wait for the chunks the workers are still busy with. Copy lives on this
+  // stack, so it must not be visible to them anymore afterwards.
+  std::unique_lock<std::mutex> Lock(Pool.Mutex);
+  Pool.WorkersIdle.wait(Lock, [&](){ return Pool.NumBusyWorkers == 0; });
+  Pool.Copy = nullptr;
+  Assert(Copy.NumChunksDone.load(std::memory_order_acquire) == Copy.NumChunks);
 }
 
 auto
 ::MemSetBytes(memory_size Size, void* Destination, int Value)
   -> void
 {
+  if(Size >= Bytes(Mem_NonTemporalThreshold))
+    MemSetBytesNonTemporal(Size, Destination, Value);
+  else
+    std::memset(Destination, Value, ToBytes(Size));
+}
+
+auto
+::MemSetBytesNonTemporal(memory_size Size, void* Destination, int Value)
+  -> void
+{
+#if defined(BB_Platform_x64)
+  auto To = Reinterpret<uint8*>(Destination);
+  size_t NumBytes = ToBytes(Size);
+
+  auto const NumHeadBytes = MemNumBytesUntilAligned(NumBytes, To, 32);
+  std::memset(To, Value, NumHeadBytes);
+  To += NumHeadBytes;
+  NumBytes -= NumHeadBytes;
+
+  auto const NumBodyBytes = AlignDown(NumBytes, Mem_StreamBlockSize);
+  if(CpuHasFeature(Cpu_AVX))
+    MemStreamSetAVX(NumBodyBytes, To, uint8(Value));
+  else
+    MemStreamSetSSE2(NumBodyBytes, To, uint8(Value));
+
+  _mm_sfence();
+
+  std::memset(To + NumBodyBytes, Value, NumBytes - NumBodyBytes);
+#else
   std::memset(Destination, Value, ToBytes(Size));
+#endif
+}
+
+// The pattern kernels write Block over NumBytes of Destination, which must be
+// a multiple of Mem_PatternBlockSize. Destination doesn't need to be aligned.
+
+enum { Mem_PatternBlockSize = 64 };
+
+#if defined(BB_Platform_x64)
+
+BB_TargetFeatures("avx")
+static void
+MemSetPatternBlocksAVX(size_t NumBytes, uint8* Destination, uint8 const* Block)
+{
+  auto const A = _mm256_loadu_si256(Reinterpret<__m256i const*>(Block) + 0);
+  auto const B = _mm256_loadu_si256(Reinterpret<__m256i const*>(Block) + 1);
+  for(size_t Offset = 0; Offset < NumBytes; Offset += Mem_PatternBlockSize)
+  {
+    auto const To = Reinterpret<__m256i*>(Destination + Offset);
+    _mm256_storeu_si256(To + 0, A);
+    _mm256_storeu_si256(To + 1, B);
+  }
+}
+
+static void
+MemSetPatternBlocksSSE2(size_t NumBytes, uint8* Destination, uint8 const* Block)
+{
+  auto const A = _mm_loadu_si128(Reinterpret<__m128i const*>(Block) + 0);
+  auto const B = _mm_loadu_si128(Reinterpret<__m128i const*>(Block) + 1);
+  auto const C = _mm_loadu_si128(Reinterpret<__m128i const*>(Block) + 2);
+  auto const D = _mm_loadu_si128(Reinterpret<__m128i const*>(Block) + 3);
+  for(size_t Offset = 0; Offset < NumBytes; Offset += Mem_PatternBlockSize)
+  {
+    auto const To = Reinterpret<__m128i*>(Destination + Offset);
+    _mm_storeu_si128(To + 0, A);
+    _mm_storeu_si128(To + 1, B);
+    _mm_storeu_si128(To + 2, C);
+    _mm_storeu_si128(To + 3, D);
+  }
+}
+
+#else
+
+static void
+MemSetPatternBlocks(size_t NumBytes, uint8* Destination, uint8 const* Block)
+{
+  // A fixed size lets the compiler turn this into vector stores.
+  for(size_t Offset = 0; Offset < NumBytes; Offset += Mem_PatternBlockSize)
+    std::memcpy(Destination + Offset, Block, Mem_PatternBlockSize);
+}
+
+#endif
+
+auto
+::MemSetPatternBytes(memory_size Size, void* Destination, memory_size PatternSize, void const* Pattern)
+  -> void
+{
+  auto const NumBytes = Convert<size_t>(ToBytes(Size));
+  auto const NumPatternBytes = Convert<size_t>(ToBytes(PatternSize));
+  Assert(NumPatternBytes > 0);
+
+  auto To = Reinterpret<uint8*>(Destination);
+  auto From = Reinterpret<uint8 const*>(Pattern);
+
+  if(NumPatternBytes == 1)
+  {
+    MemSetBytes(Size, Destination, *From);
+    return;
+  }
+
+  if(Mem_PatternBlockSize % NumPatternBytes == 0)
+  {
+    // Small patterns: Repeat the pattern into a block that fits into vector
+    // registers and write the block over and over.
+    uint8 Block[Mem_PatternBlockSize];
+    for(size_t Offset = 0; Offset < Mem_PatternBlockSize; Offset += NumPatternBytes)
+      std::memcpy(Block + Offset, From, NumPatternBytes);
+
+    auto const NumBlockBytes = AlignDown(NumBytes, Mem_PatternBlockSize);
+  #if defined(BB_Platform_x64)
+    if(CpuHasFeature(Cpu_AVX))
+      MemSetPatternBlocksAVX(NumBlockBytes, To, Block);
+    else
+      MemSetPatternBlocksSSE2(NumBlockBytes, To, Block);
+  #else
+    MemSetPatternBlocks(NumBlockBytes, To, Block);
+  #endif
+
+    std::memcpy(To + NumBlockBytes, Block, NumBytes - NumBlockBytes);
+    return;
+  }
+
+  // Other patterns: Copy the pattern once, then keep doubling the filled
+  // part. Past a certain size, keep copying the same chunk from the front so
+  // it can stay in the cache.
+  size_t const MaxChunkSize = Max(size_t(KiB(32)) / NumPatternBytes, size_t(1)) * NumPatternBytes;
+  auto NumFilled = Min(NumPatternBytes, NumBytes);
+  std::memmove(To, From, NumFilled);
+  while(NumFilled < NumBytes)
+  {
+    auto const NumToCopy = Min(Min(NumFilled, MaxChunkSize), NumBytes - NumFilled);
+    std::memcpy(To + NumFilled, To, NumToCopy);
+    NumFilled += NumToCopy;
+  }
+}
+
+#if defined(BB_Platform_x64)
+
+// The compare kernels need at least one full vector of bytes. They return the
+// offset of the first difference, or NumBytes if there is none. The end of
+// the range is compared with a vector that overlaps the previous one.
+
+BB_TargetFeatures("avx2")
+static size_t
+MemFindFirstDifferenceAVX2(size_t NumBytes, uint8 const* A, uint8 const* B)
+{
+  auto Compare = [=](size_t Offset) BB_TargetFeatures("avx2")
+  {
+    return uint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(Reinterpret<__m256i const*>(A + Offset)),
+                                                         _mm256_loadu_si256(Reinterpret<__m256i const*>(B + Offset)))));
+  };
+
+  auto const FirstMask = Compare(0);
+  if(FirstMask != 0xFFFFFFFFu)
+    return FindFirstSetBit(~FirstMask);
+
+  // Loads that cross cache lines are slow, so continue where A is aligned.
+  size_t Offset = 32 - (Reinterpret<size_t>(A) & 31);
+  for(; Offset + 128 <= NumBytes; Offset += 128)
+  {
+    auto const FromA = Reinterpret<__m256i const*>(A + Offset);
+    auto const FromB = Reinterpret<__m256i const*>(B + Offset);
+    auto const Equal0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(FromA + 0), _mm256_loadu_si256(FromB + 0));
+    auto const Equal1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(FromA + 1), _mm256_loadu_si256(FromB + 1));
+    auto const Equal2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(FromA + 2), _mm256_loadu_si256(FromB + 2));
+    auto const Equal3 = _mm256_cmpeq_epi8(_mm256_loadu_si256(FromA + 3), _mm256_loadu_si256(FromB + 3));
+    auto const Equal = _mm256_and_si256(_mm256_and_si256(Equal0, Equal1), _mm256_and_si256(Equal2, Equal3));
+    if(uint32(_mm256_movemask_epi8(Equal)) != 0xFFFFFFFFu)
+      break;
+  }
+
+  for(; Offset + 32 <= NumBytes; Offset += 32)
+  {
+    auto const Mask = Compare(Offset);
+    if(Mask != 0xFFFFFFFFu)
+      return Offset + FindFirstSetBit(~Mask);
+  }
+
+  if(Offset < NumBytes)
+  {
+    Offset = NumBytes - 32;
+    auto const Mask = Compare(Offset);
+    if(Mask != 0xFFFFFFFFu)
+      return Offset + FindFirstSetBit(~Mask);
+  }
+
+  return NumBytes;
+}
+
+static size_t
+MemFindFirstDifferenceSSE2(size_t NumBytes, uint8 const* A, uint8 const* B)
+{
+  auto Compare = [=](size_t Offset)
+  {
+    return uint32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(Reinterpret<__m128i const*>(A + Offset)),
+                                                   _mm_loadu_si128(Reinterpret<__m128i const*>(B + Offset)))));
+  };
+
+  auto const FirstMask = Compare(0);
+  if(FirstMask != 0xFFFFu)
+    return FindFirstSetBit(~FirstMask & 0xFFFFu);
+
+  size_t Offset = 16 - (Reinterpret<size_t>(A) & 15);
+  for(; Offset + 64 <= NumBytes; Offset += 64)
+  {
+    auto const FromA = Reinterpret<__m128i const*>(A + Offset);
+    auto const FromB = Reinterpret<__m128i const*>(B + Offset);
+    auto const Equal0 = _mm_cmpeq_epi8(_mm_loadu_si128(FromA + 0), _mm_loadu_si128(FromB + 0));
+    auto const Equal1 = _mm_cmpeq_epi8(_mm_loadu_si128(FromA + 1), _mm_loadu_si128(FromB + 1));
+    auto const Equal2 = _mm_cmpeq_epi8(_mm_loadu_si128(FromA + 2), _mm_loadu_si128(FromB + 2));
+    auto const Equal3 = _mm_cmpeq_epi8(_mm_loadu_si128(FromA + 3), _mm_loadu_si128(FromB + 3));
+    auto const Equal = _mm_and_si128(_mm_and_si128(Equal0, Equal1), _mm_and_si128(Equal2, Equal3));
+    if(_mm_movemask_epi8(Equal) != 0xFFFF)
+      break;
+  }
+
+  for(; Offset + 16 <= NumBytes; Offset += 16)
+  {
+    auto const Mask = Compare(Offset);
+    if(Mask != 0xFFFFu)
+      return Offset + FindFirstSetBit(~Mask & 0xFFFFu);
+  }
+
+  if(Offset < NumBytes)
+  {
+    Offset = NumBytes - 16;
+    auto const Mask = Compare(Offset);
+    if(Mask != 0xFFFFu)
+      return Offset + FindFirstSetBit(~Mask & 0xFFFFu);
+  }
+
+  return NumBytes;
+}
+
+#endif
+
+auto
+::MemFindFirstDifference(memory_size Size, void const* A, void const* B)
+  -> size_t
+{
+  auto const NumBytes = Convert<size_t>(ToBytes(Size));
+  auto const BytesA = Reinterpret<uint8 const*>(A);
+  auto const BytesB = Reinterpret<uint8 const*>(B);
+  if(BytesA == BytesB)
+    return NumBytes;
+
+#if defined(BB_Platform_x64)
+  if(NumBytes >= 32 && CpuHasFeature(Cpu_AVX2))
+    return MemFindFirstDifferenceAVX2(NumBytes, BytesA, BytesB);
+  if(NumBytes >= 16)
+    return MemFindFirstDifferenceSSE2(NumBytes, BytesA, BytesB);
+#endif
+
+  // Compare 8 bytes at a time. The lowest differing bit of two little-endian
+  // words belongs to the first differing byte.
+  size_t Offset = 0;
+  for(; Offset + 8 <= NumBytes; Offset += 8)
+  {
+    uint64 WordA, WordB;
+    std::memcpy(&WordA, BytesA + Offset, 8);
+    std::memcpy(&WordB, BytesB + Offset, 8);
+    if(WordA != WordB)
+      return Offset + FindFirstSetBit(WordA ^ WordB) / 8;
+  }
+
+  for(; Offset < NumBytes; ++Offset)
+  {
+    if(BytesA[Offset] != BytesB[Offset])
+      return Offset;
+  }
+
+  return NumBytes;
 }
 
 auto
 ::MemEqualBytes(memory_size Size, void const* A, void const* B)
   -> bool
 {
-  return MemCompareBytes(Size, A, B) == 0;
+  return MemFindFirstDifference(Size, A, B) == ToBytes(Size);
 }
 
 auto
 ::MemCompareBytes(memory_size Size, void const* A, void const* B)
   -> int
 {
-  return std::memcmp(A, B, ToBytes(Size));
+  auto const Offset = MemFindFirstDifference(Size, A, B);
+  if(Offset == ToBytes(Size))
+    return 0;
+
+  return int(Reinterpret<uint8 const*>(A)[Offset]) - int(Reinterpret<uint8 const*>(B)[Offset]);
 }
 
 auto
@@ -44,10 +691,9 @@ auto
   auto LeftB = Reinterpret<size_t const>(B);
   auto RightB = LeftB + ToBytes(SizeB);
 
-  return LeftB  >= LeftA && LeftB  <= RightA || // Check if LeftB  is in [A, A+NumBytesA]
-         RightB >= LeftA && RightB <= RightA || // Check if RightB is in [A, A+NumBytesA]
-         LeftA  >= LeftB && LeftA  <= RightB || // Check if LeftA  is in [B, B+NumBytesB]
-         RightA >= LeftB && RightA <= RightB;   // Check if RightA is in [B, B+NumBytesB]
+  // Both ranges are half-open, i.e. [A, A+NumBytesA) and [B, B+NumBytesB),
+  // so adjacent ranges do not overlap.
+  return LeftA < RightB && LeftB < RightA;
 }
 
 //]]~~
@@ -15,35 +15,135 @@
 /// which C standard functionality is covered by which of the functions
 /// defined here.
 ///
-/// C Standard Function | Untyped/Bytes                   | Typed
-/// ------------------- | ------------------------------- | -----
-/// memcopy, memmove    | MemCopyBytes                    | MemCopy, MemCopyConstruct, MemMove, MemMoveConstruct
-/// memset              | MemSetBytes                     | MemSet, MemConstruct
-/// memcmp              | MemCompareBytes, MemEqualBytes  | -
+/// C Standard Function | Untyped/Bytes                                                                                         | Typed
+/// ------------------- | ----------------------------------------------------------------------------------------------------- | -----
+/// memcopy, memmove    | MemCopyBytes, MemCopyBytesNonOverlapping, MemCopyBytesNonTemporal, MemCopyBytesParallel, MemCopyBatch | MemCopy, MemCopyConstruct, MemMove, MemMoveConstruct
+/// memset              | MemSetBytes, MemSetBytesNonTemporal, MemSetPatternBytes                                               | MemSet, MemConstruct
+/// memcmp              | MemCompareBytes, MemEqualBytes, MemFindFirstDifference                                                | -
 ///
 ///
-/// All functions are optimized for POD types.
+/// Each function picks the fastest path that is valid for the type at hand,
+/// based on IsTriviallyDefaultConstructible, IsZeroInitializable,
+/// IsTriviallyCopyable, IsTriviallyDestructible and IsTriviallyRelocatable.
+/// IsZeroInitializable and IsTriviallyRelocatable can be opted into for types
+/// the compiler can't see through.
 ///
 /// @{
 
 RESERVE_PREFIX(Mem);
 
+enum
+{
+  /// Copies and fills of at least this many bytes use non-temporal stores,
+  /// which write around the cache. Buffers this large would evict most of the
+  /// last level cache while not being read back from it anyway.
+  Mem_NonTemporalThreshold = 8 * 1024 * 1024,
+
+  /// MemCopyBytesParallel copies anything smaller than this on the calling
+  /// thread alone. Waking up the workers would cost more than they save.
+  Mem_ParallelCopyThreshold = 64 * 1024 * 1024,
+};
+
 /// Copy NumBytes from Source to Destination.
 ///
-/// Destination and Source may overlap.
+/// Destination and Source may overlap. If they don't, this is the same as
+/// MemCopyBytesNonOverlapping.
 void
 MemCopyBytes(memory_size Size, void* Destination, void const* Source);
 
+/// Copy NumBytes from Source to Destination.
+///
+/// Destination and Source may NOT overlap. Sizes of at least
+/// Mem_NonTemporalThreshold go through MemCopyBytesNonTemporal.
+void
+MemCopyBytesNonOverlapping(memory_size Size, void* Destination, void const* Source);
+
+/// Copy NumBytes from Source to Destination with non-temporal stores,
+/// regardless of the size.
+///
+/// Meant for large buffers that are not going to be read again soon. Uses AVX
+/// if the CPU supports it, SSE2 otherwise.
+///
+/// Destination and Source may NOT overlap.
+void
+MemCopyBytesNonTemporal(memory_size Size, void* Destination, void const* Source);
+
+/// One copy in a batch for MemCopyBatch.
+struct mem_copy_op
+{
+  memory_size Size;
+  void* Destination;
+  void const* Source;
+};
+
+template<typename ElementType>
+struct slice;
+
+/// Execute all copies in Ops, in order.
+///
+/// Meant for many small copies, e.g. when assembling a packet from fragments.
+/// Copies of up to 64 bytes use fixed-size moves instead of a call to memcpy,
+/// and the sources of upcoming copies are prefetched.
+///
+/// Destination and Source of a copy may NOT overlap, neither with each other
+/// nor with those of other copies in the batch.
+void
+MemCopyBatch(slice<mem_copy_op const> Ops);
+
+/// Copy NumBytes from Source to Destination using multiple threads.
+///
+/// The range is split into page-aligned chunks that the calling thread and a
+/// pool of worker threads copy concurrently. The pool has one thread less
+/// than there are hardware threads and is started on first use. Only one
+/// parallel copy runs at a time, concurrent calls wait for their turn.
+///
+/// Sizes below Mem_ParallelCopyThreshold go through
+/// MemCopyBytesNonOverlapping on the calling thread.
+///
+/// Destination and Source may NOT overlap.
+void
+MemCopyBytesParallel(memory_size Size, void* Destination, void const* Source);
+
 /// Fill NumBytes in Destination with the value
+///
+/// Sizes of at least Mem_NonTemporalThreshold go through
+/// MemSetBytesNonTemporal.
 void
 MemSetBytes(memory_size Size, void* Destination, int Value);
 
+/// Fill NumBytes in Destination with the value using non-temporal stores,
+/// regardless of the size.
+void
+MemSetBytesNonTemporal(memory_size Size, void* Destination, int Value);
+
+/// Fill NumBytes in Destination with copies of the PatternSize bytes at
+/// Pattern, back to back.
+///
+/// If Size is not a multiple of PatternSize, the last copy is cut short.
+/// Pattern may point into Destination.
+void
+MemSetPatternBytes(memory_size Size, void* Destination, memory_size PatternSize, void const* Pattern);
+
+/// Whether the first NumBytes of A and B are the same.
 bool
 MemEqualBytes(memory_size Size, void const* A, void const* B);
 
+/// Compare the first NumBytes of A and B like memcmp does.
+///
+/// \return Less than zero if the first differing byte is smaller in A than in
+///         B, greater than zero if it is bigger, zero if all bytes are equal.
 int
 MemCompareBytes(memory_size Size, void const* A, void const* B);
 
+/// Find the first byte that differs between A and B.
+///
+/// Uses AVX2 if the CPU supports it, SSE2 otherwise.
+///
+/// \return The byte offset of the first difference, or NumBytes if all bytes
+///         are equal.
+size_t
+MemFindFirstDifference(memory_size Size, void const* A, void const* B);
+
 bool
 MemAreOverlapping(memory_size SizeA, void const* A, memory_size SizeB, void const* B);
 
@@ -78,6 +178,10 @@ MemCopyConstruct(size_t Num, T* Destination, T const* Source);
 /// Move all elements from Source to Destination using T's constructor.
 ///
 /// Destination and Source may overlap.
+///
+/// Trivially relocatable types are moved with a single MemCopyBytes.
+///
+/// \see IsTriviallyRelocatable
 template<typename T>
 void
 MemMove(size_t Num, T* Destination, T* Source);
@@ -86,6 +190,9 @@ MemMove(size_t Num, T* Destination, T* Source);
 ///
 /// Destination and Source may NOT overlap. Destination is assumed to be
 /// uninitialized.
+///
+/// Trivially relocatable types are moved with a single MemCopyBytes and no
+/// destructor calls.
 template<typename T>
 void
 MemMoveConstruct(size_t Num, T* Destination, T* Source);
@@ -115,7 +222,7 @@ MemAreOverlapping(size_t NumA, TA const* A, size_t NumB, TB const* B)
 
 // MemConstruct
 
-template<typename T, bool TIsPlainOldData = false>
+template<typename T, bool TIsTrivial = false>
 struct impl_mem_construct
 {
   template<typename... ArgTypes>
@@ -141,26 +248,35 @@ struct impl_mem_construct<T, true>
   inline static void
   Do(size_t Num, T* Destination, T const& Item)
   {
-    // Blit Item over each element of Destination.
-    for(size_t Index = 0; Index < Num; ++Index)
-    {
-      MemCopyBytes(SizeOf<T>(), &Destination[Index], &Item);
-    }
+    // Blit Item over all of Destination.
+    MemSetPatternBytes(Num * SizeOf<T>(), Destination, SizeOf<T>(), &Item);
   }
 };
 
+/// Whether ArgTypes is a single T, i.e. MemConstruct copies an item.
+template<typename T, typename... ArgTypes> struct impl_mem_is_copy_of_item             { static constexpr bool Value = false; };
+template<typename T, typename ArgType>     struct impl_mem_is_copy_of_item<T, ArgType> { static constexpr bool Value = std::is_same<T, rm_ref_const<ArgType>>::value; };
+
+template<typename T, typename... ArgTypes>
+constexpr bool
+MemIsTrivialConstruction()
+{
+  return sizeof...(ArgTypes) == 0 ? IsZeroInitializable<T>()
+                                  : IsTriviallyCopyable<T>() && impl_mem_is_copy_of_item<T, ArgTypes...>::Value;
+}
+
 template<typename T, typename... ArgTypes>
 inline auto
 MemConstruct(size_t Num, T* Destination, ArgTypes&&... Args)
   -> void
 {
-  impl_mem_construct<T, IsPOD<T>()>::Do(Num, Destination, Forward<ArgTypes>(Args)...);
+  impl_mem_construct<T, MemIsTrivialConstruction<T, ArgTypes...>()>::Do(Num, Destination, Forward<ArgTypes>(Args)...);
 }
 
 
 // MemDestruct
 
-template<typename T, bool TIsPlainOldData = false>
+template<typename T, bool TIsTriviallyDestructible = false>
 struct impl_mem_destruct
 {
   inline static void
@@ -179,7 +295,7 @@ struct impl_mem_destruct<T, true>
   inline static void
   Do(size_t Num, T* Destination)
   {
-    // Nothing to do for POD types.
+    // Nothing to do for trivially destructible types.
   }
 };
 
@@ -188,13 +304,13 @@ inline auto
 MemDestruct(size_t Num, T* Destination)
   -> void
 {
-  impl_mem_destruct<T, IsPOD<T>()>::Do(Num, Destination);
+  impl_mem_destruct<T, IsTriviallyDestructible<T>()>::Do(Num, Destination);
 }
 
 
 // MemCopy
 
-template<typename T, bool TIsPlainOldData = false>
+template<typename T, bool TIsTriviallyCopyable = false>
 struct impl_mem_copy
 {
   inline static void
@@ -238,13 +354,13 @@ inline auto
 MemCopy(size_t Num, T* Destination, T const* Source)
   -> void
 {
-  impl_mem_copy<T, IsPOD<T>()>::Do(Num, Destination, Source);
+  impl_mem_copy<T, IsTriviallyCopyable<T>()>::Do(Num, Destination, Source);
 }
 
 
 // MemCopyConstruct
 
-template<typename T, bool TIsPlainOldData = false>
+template<typename T, bool TIsTriviallyCopyable = false>
 struct impl_mem_copy_construct
 {
   inline static void
@@ -267,11 +383,11 @@ struct impl_mem_copy_construct<T, true>
   Do(size_t Num, T* Destination, T const* Source)
   {
     // When using the constructor, overlapping is not allowed. Even though in
-    // the POD case here it doesn't make a difference, it might help to catch
-    // bugs since this can't be intentional.
+    // the trivial case here it doesn't make a difference, it might help to
+    // catch bugs since this can't be intentional.
     Assert(!MemAreOverlapping(Num, Destination, Num, Source));
 
-    MemCopy(Num, Destination, Source);
+    MemCopyBytesNonOverlapping(SizeOf<T>() * Num, Destination, Source);
   }
 };
 
@@ -280,13 +396,13 @@ inline auto
 MemCopyConstruct(size_t Num, T* Destination, T const* Source)
   -> void
 {
-  impl_mem_copy_construct<T, IsPOD<T>()>::Do(Num, Destination, Source);
+  impl_mem_copy_construct<T, IsTriviallyCopyable<T>()>::Do(Num, Destination, Source);
 }
 
 
 // MemMove
 
-template<typename T, bool TIsPlainOldData = false>
+template<typename T, bool TIsTriviallyRelocatable = false>
 struct impl_mem_move
 {
   inline static void
@@ -336,20 +452,45 @@ struct impl_mem_move
 };
 
 template<typename T>
-struct impl_mem_move<T, true> : public impl_mem_copy<T, true> {};
+struct impl_mem_move<T, true>
+{
+  inline static void
+  Do(size_t Num, T* Destination, T* Source)
+  {
+    if(Destination == Source)
+      return;
+
+    // The elements are relocated by copying their bytes, so the ones in
+    // Source are never destructed. Only the elements in Destination that are
+    // about to be overwritten without having been relocated have to go.
+    if(MemAreOverlapping(Num, Destination, Num, Source))
+    {
+      if(Destination < Source)
+        MemDestruct(Source - Destination, Destination);
+      else
+        MemDestruct(Destination - Source, MemAddOffset(Source, Num));
+    }
+    else
+    {
+      MemDestruct(Num, Destination);
+    }
+
+    MemCopyBytes(SizeOf<T>() * Num, Destination, Source);
+  }
+};
 
 template<typename T>
 inline auto
 MemMove(size_t Num, T* Destination, T* Source)
   -> void
 {
-  impl_mem_move<T, IsPOD<T>()>::Do(Num, Destination, Source);
+  impl_mem_move<T, IsTriviallyRelocatable<T>()>::Do(Num, Destination, Source);
 }
 
 
 // MemMoveConstruct
 
-template<typename T, bool TIsPlainOldData = false>
+template<typename T, bool TIsTriviallyRelocatable = false>
 struct impl_mem_move_construct
 {
   inline static void
@@ -370,14 +511,16 @@ template<typename T>
 struct impl_mem_move_construct<T, true>
 {
   inline static void
-  Do(size_t Num, T* Destination, T const* Source)
+  Do(size_t Num, T* Destination, T* Source)
   {
     // When using the constructor, overlapping is not allowed. Even though in
-    // the POD case here it doesn't make a difference, it might help to catch
-    // bugs since this can't be intentional.
+    // the relocatable case here it doesn't make a difference, it might help to
+    // catch bugs since this can't be intentional.
     Assert(!MemAreOverlapping(Num, Destination, Num, Source));
 
-    MemCopy(Num, Destination, Source);
+    // Relocating the bytes ends the lifetime of the objects in Source without
+    // calling their destructor.
+    MemCopyBytesNonOverlapping(SizeOf<T>() * Num, Destination, Source);
   }
 };
 
@@ -386,13 +529,13 @@ inline auto
 MemMoveConstruct(size_t Num, T* Destination, T* Source)
   -> void
 {
-  impl_mem_move_construct<T, IsPOD<T>()>::Do(Num, Destination, Source);
+  impl_mem_move_construct<T, IsTriviallyRelocatable<T>()>::Do(Num, Destination, Source);
 }
 
 
 // MemSet
 
-template<typename T, bool TIsPlainOldData = false>
+template<typename T, bool TIsTrivial = false>
 struct impl_mem_set
 {
   inline static void
@@ -422,7 +565,7 @@ inline auto
 MemSet(size_t Num, T* Destination)
   -> void
 {
-  impl_mem_set<T, IsPOD<T>()>::Do(Num, Destination);
+  impl_mem_set<T, IsZeroInitializable<T>() && IsTriviallyCopyable<T>()>::Do(Num, Destination);
 }
 
 template<typename T>
@@ -430,7 +573,7 @@ inline auto
 MemSet(size_t Num, T* Destination, T const& Item)
   -> void
 {
-  impl_mem_set<T, IsPOD<T>()>::Do(Num, Destination, Item);
+  impl_mem_set<T, IsTriviallyCopyable<T>()>::Do(Num, Destination, Item);
 }
 
 /// @}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Slice.hpp"
+#include "Allocator.hpp"
 
 //~~[[
 
@@ -31,6 +32,15 @@ ExtractPathDirectoryAndFileName(slice<char> Path, slice<char>* Out_Directory, sl
 inline slice<char>
 ConcatPaths(slice<char const> Head, slice<char const> Tail, slice<char> Buffer, path_options Options = {});
 
+/// Like the overload above but the buffer is allocated from Allocator.
+///
+/// The allocation is exactly as large as needed, including the null
+/// terminator if Options.AppendNull is set.
+///
+/// \return An empty slice if out of memory.
+inline slice<char>
+ConcatPaths(slice<char const> Head, slice<char const> Tail, allocator Allocator, path_options Options = {});
+
 inline slice<char>
 FindFileExtension(slice<char> FileName, path_options Options = {});
 
@@ -57,6 +57,19 @@ auto
   return Result;
 }
 
+auto
+::ConcatPaths(slice<char const> Head, slice<char const> Tail, allocator Allocator,
+              path_options Options)
+  -> slice<char>
+{
+  auto const BufferSize = Head.Num + 1 + Tail.Num + (Options.AppendNull ? 1 : 0);
+  auto Buffer = AllocatorAllocate<char>(Allocator, BufferSize);
+  if(Buffer.Num != BufferSize)
+    return {};
+
+  return ConcatPaths(Head, Tail, Buffer, Options);
+}
+
 template<typename CharType>
 struct impl_find_file_extension
 {
@@ -0,0 +1,21 @@
+#include "Pool.hpp"
+#include "Heap.hpp"
+
+//~~[[
+
+auto
+::ImplPoolAllocateBlock(memory_size Size, size_t Alignment)
+  -> impl_pool_block*
+{
+  Assert(Size >= SizeOf<impl_pool_block>());
+  return Reinterpret<impl_pool_block*>(MemAllocate(Size, Max(Alignment, alignof(impl_pool_block))));
+}
+
+auto
+::ImplPoolFreeBlock(impl_pool_block* Block)
+  -> void
+{
+  MemFree(Block);
+}
+
+//]]~~
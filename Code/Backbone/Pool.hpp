@@ -0,0 +1,243 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Memory.hpp"
+#include "Allocator.hpp"
+#include "AllocationStats.hpp"
+
+//~~[[
+
+RESERVE_PREFIX(Pool);
+
+struct impl_pool_block
+{
+  impl_pool_block* Next;
+};
+
+/// Allocate a block of the given size and alignment for use in a pool.
+///
+/// \return \c nullptr if out of memory.
+impl_pool_block*
+ImplPoolAllocateBlock(memory_size Size, size_t Alignment);
+
+void
+ImplPoolFreeBlock(impl_pool_block* Block);
+
+/// A typed allocator for objects of a fixed size.
+///
+/// Slots are carved out of large blocks. Freed slots are kept on an
+/// intrusive free list, i.e. the memory of a free slot is used to link it to
+/// the next free slot. Creating and destroying an object is O(1) and blocks
+/// are only returned to the heap in PoolFinalize.
+///
+/// Usage:
+/// \code
+/// pool<foo> Foos;
+/// PoolInit(&Foos);
+/// Defer [&](){ PoolFinalize(&Foos); };
+///
+/// foo* Foo = PoolCreate(&Foos, 42);
+/// /* ... */
+/// PoolDestroy(&Foos, Foo);
+/// \endcode
+template<typename T>
+struct pool
+{
+  using element_type = T;
+
+  union slot
+  {
+    slot* NextFree;
+    alignas(T) uint8 Storage[sizeof(T)];
+  };
+
+  /// Singly linked list of all blocks owned by this pool.
+  impl_pool_block* Blocks;
+
+  /// Slots that were in use before and are free now.
+  slot* FreeList;
+
+  /// The range of never used slots in the most recent block.
+  slot* Unused;
+  slot* UnusedEnd;
+
+  /// How many slots are carved out of a single block.
+  size_t NumSlotsPerBlock;
+
+  /// Number of objects currently alive.
+  size_t NumLive;
+
+  /// Where to record allocations. May be \c nullptr.
+  ///
+  /// \see allocation_stats
+  allocation_stats* Stats;
+};
+
+template<typename T>
+constexpr size_t
+ImplPoolSlotOffset()
+{
+  // The first slot starts after the block header, respecting the alignment
+  // of the slots.
+  return AlignUp(sizeof(impl_pool_block), alignof(typename pool<T>::slot));
+}
+
+/// \param BlockSize The size of a single block that is allocated whenever the
+///                  pool runs out of slots. At least one slot is carved out
+///                  of each block.
+template<typename T>
+void
+PoolInit(pool<T>* Pool, memory_size BlockSize = KiB(64))
+{
+  using slot = typename pool<T>::slot;
+
+  Assert(Pool);
+  *Pool = {};
+
+  auto const SlotSize = Convert<size_t>(ToBytes(SizeOf<slot>()));
+  auto const UsableSize = Convert<size_t>(ToBytes(BlockSize)) - Min(Convert<size_t>(ToBytes(BlockSize)), ImplPoolSlotOffset<T>());
+  Pool->NumSlotsPerBlock = Max(size_t(1), UsableSize / SlotSize);
+}
+
+/// Return all blocks to the heap.
+///
+/// Objects that are still alive are NOT destructed.
+template<typename T>
+void
+PoolFinalize(pool<T>* Pool)
+{
+  Assert(Pool);
+  if(Pool->NumLive > 0)
+    AllocStatsRecordFree(Pool->Stats, Pool->NumLive * SizeOf<typename pool<T>::slot>());
+
+  auto Block = Pool->Blocks;
+  while(Block)
+  {
+    auto Next = Block->Next;
+    ImplPoolFreeBlock(Block);
+    Block = Next;
+  }
+
+  *Pool = {};
+}
+
+template<typename T>
+typename pool<T>::slot*
+ImplPoolAllocateSlot(pool<T>* Pool)
+{
+  using slot = typename pool<T>::slot;
+
+  Assert(Pool);
+  Assert(Pool->NumSlotsPerBlock > 0); // Pool not initialized?
+
+  slot* Slot = Pool->FreeList;
+  if(Slot)
+  {
+    Pool->FreeList = Slot->NextFree;
+  }
+  else
+  {
+    if(Pool->Unused == Pool->UnusedEnd)
+    {
+      auto const BlockSize = Bytes(ImplPoolSlotOffset<T>()) + Pool->NumSlotsPerBlock * SizeOf<slot>();
+      auto Block = ImplPoolAllocateBlock(BlockSize, alignof(slot));
+      if(Block == nullptr)
+        return nullptr;
+
+      Block->Next = Pool->Blocks;
+      Pool->Blocks = Block;
+      Pool->Unused = Reinterpret<slot*>(MemAddByteOffset(Block, ImplPoolSlotOffset<T>()));
+      Pool->UnusedEnd = MemAddOffset(Pool->Unused, Pool->NumSlotsPerBlock);
+    }
+
+    Slot = Pool->Unused++;
+  }
+
+  ++Pool->NumLive;
+  AllocStatsRecordAllocation(Pool->Stats, SizeOf<slot>());
+  return Slot;
+}
+
+template<typename T>
+void
+ImplPoolFreeSlot(pool<T>* Pool, typename pool<T>::slot* Slot)
+{
+  Assert(Pool->NumLive > 0);
+
+  Slot->NextFree = Pool->FreeList;
+  Pool->FreeList = Slot;
+  --Pool->NumLive;
+  AllocStatsRecordFree(Pool->Stats, SizeOf<typename pool<T>::slot>());
+}
+
+/// Get a slot for a new object and construct it with Args.
+///
+/// \see MemConstruct
+/// \return \c nullptr if out of memory.
+template<typename T, typename... ArgTypes>
+T*
+PoolCreate(pool<T>* Pool, ArgTypes&&... Args)
+{
+  auto Slot = ImplPoolAllocateSlot(Pool);
+  if(Slot == nullptr)
+    return nullptr;
+
+  auto Object = Reinterpret<T*>(&Slot->Storage[0]);
+  MemConstruct(1, Object, Forward<ArgTypes>(Args)...);
+  return Object;
+}
+
+/// Destruct the given object and put its slot back on the free list.
+///
+/// \param Object Must have been created from this pool. May be \c nullptr.
+template<typename T>
+void
+PoolDestroy(pool<T>* Pool, T* Object)
+{
+  using slot = typename pool<T>::slot;
+
+  Assert(Pool);
+  if(Object == nullptr)
+    return;
+
+  MemDestruct(1, Object);
+  ImplPoolFreeSlot(Pool, Reinterpret<slot*>(Object));
+}
+
+template<typename T>
+void*
+ImplPoolAllocatorAllocate(void* Context, memory_size Size, size_t Alignment)
+{
+  using slot = typename pool<T>::slot;
+
+  // Only requests that fit into a single slot can be served.
+  if(Size > SizeOf<slot>() || Alignment > alignof(slot))
+    return nullptr;
+
+  return ImplPoolAllocateSlot(Reinterpret<pool<T>*>(Context));
+}
+
+template<typename T>
+void
+ImplPoolAllocatorFree(void* Context, void* Ptr, memory_size Size)
+{
+  ImplPoolFreeSlot(Reinterpret<pool<T>*>(Context), Reinterpret<typename pool<T>::slot*>(Ptr));
+}
+
+/// Get an allocator that hands out the slots of the given pool.
+///
+/// Only allocations of at most one slot in size and alignment succeed. No
+/// objects are constructed or destructed by that allocator.
+template<typename T>
+allocator
+AllocatorFrom(pool<T>* Pool)
+{
+  allocator Result;
+  Result.Context = Pool;
+  Result.AllocateFunc = ImplPoolAllocatorAllocate<T>;
+  Result.ReallocateFunc = nullptr;
+  Result.FreeFunc = ImplPoolAllocatorFree<T>;
+  return Result;
+}
+
+//]]~~
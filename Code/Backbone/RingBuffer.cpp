@@ -0,0 +1,181 @@
+#include "RingBuffer.hpp"
+#include "Memory.hpp"
+
+#if defined(BB_Platform_Windows)
+  #include <windows.h>
+#elif defined(BB_Platform_Linux)
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+//~~[[
+
+#if defined(BB_Platform_Windows)
+
+auto
+::RingBufferInit(ring_buffer* Buffer, memory_size MinCapacity)
+  -> bool
+{
+  Assert(Buffer);
+  *Buffer = {};
+
+  SYSTEM_INFO SystemInfo;
+  GetSystemInfo(&SystemInfo);
+  auto const Size = AlignUp(Max(Convert<size_t>(ToBytes(MinCapacity)), size_t(1)), SystemInfo.dwAllocationGranularity);
+
+  auto Section = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, DWORD(uint64(Size) >> 32), DWORD(Size), nullptr);
+  if(Section == nullptr)
+    return false;
+
+  // The views keep the section alive.
+  Defer [=](){ CloseHandle(Section); };
+
+  // Find a free range of twice the size, then map the views into it. Another
+  // thread may take the range in between, so retry a few times.
+  for(int Attempt = 0; Attempt < 16; ++Attempt)
+  {
+    auto Base = Reinterpret<uint8*>(VirtualAlloc(nullptr, 2 * Size, MEM_RESERVE, PAGE_NOACCESS));
+    if(Base == nullptr)
+      return false;
+    VirtualFree(Base, 0, MEM_RELEASE);
+
+    auto First = MapViewOfFileEx(Section, FILE_MAP_ALL_ACCESS, 0, 0, Size, Base);
+    auto Second = MapViewOfFileEx(Section, FILE_MAP_ALL_ACCESS, 0, 0, Size, Base + Size);
+    if(First && Second)
+    {
+      Buffer->Data = Base;
+      Buffer->Capacity = Size;
+      return true;
+    }
+
+    if(First)  UnmapViewOfFile(First);
+    if(Second) UnmapViewOfFile(Second);
+  }
+
+  return false;
+}
+
+auto
+::RingBufferFinalize(ring_buffer* Buffer)
+  -> void
+{
+  Assert(Buffer);
+  if(Buffer->Data)
+  {
+    UnmapViewOfFile(Buffer->Data);
+    UnmapViewOfFile(Buffer->Data + Buffer->Capacity);
+  }
+
+  *Buffer = {};
+}
+
+#elif defined(BB_Platform_Linux)
+
+auto
+::RingBufferInit(ring_buffer* Buffer, memory_size MinCapacity)
+  -> bool
+{
+  Assert(Buffer);
+  *Buffer = {};
+
+  auto const PageSize = Convert<size_t>(sysconf(_SC_PAGESIZE));
+  auto const Size = AlignUp(Max(Convert<size_t>(ToBytes(MinCapacity)), size_t(1)), PageSize);
+
+  auto const File = memfd_create("Backbone ring buffer", MFD_CLOEXEC);
+  if(File < 0)
+    return false;
+
+  // The mappings keep the memory alive.
+  Defer [=](){ close(File); };
+
+  if(ftruncate(File, Convert<off_t>(Size)) != 0)
+    return false;
+
+  // Reserve a range of twice the size, then replace both halves with the
+  // same pages of the file.
+  auto Base = Reinterpret<uint8*>(mmap(nullptr, 2 * Size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+  if(Base == MAP_FAILED)
+    return false;
+
+  auto First = mmap(Base, Size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, File, 0);
+  auto Second = mmap(Base + Size, Size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, File, 0);
+  if(First == MAP_FAILED || Second == MAP_FAILED)
+  {
+    munmap(Base, 2 * Size);
+    return false;
+  }
+
+  Buffer->Data = Base;
+  Buffer->Capacity = Size;
+  return true;
+}
+
+auto
+::RingBufferFinalize(ring_buffer* Buffer)
+  -> void
+{
+  Assert(Buffer);
+  if(Buffer->Data)
+    munmap(Buffer->Data, 2 * Buffer->Capacity);
+
+  *Buffer = {};
+}
+
+#endif
+
+auto
+::RingBufferReadable(ring_buffer const& Buffer)
+  -> slice<uint8>
+{
+  return Slice(Buffer.NumReadable, Buffer.Data + Buffer.ReadOffset);
+}
+
+auto
+::RingBufferWritable(ring_buffer const& Buffer)
+  -> slice<uint8>
+{
+  auto WriteOffset = Buffer.ReadOffset + Buffer.NumReadable;
+  if(WriteOffset >= Buffer.Capacity)
+    WriteOffset -= Buffer.Capacity;
+
+  return Slice(Buffer.Capacity - Buffer.NumReadable, Buffer.Data + WriteOffset);
+}
+
+auto
+::RingBufferCommit(ring_buffer* Buffer, size_t Num)
+  -> void
+{
+  Assert(Buffer);
+  BoundsCheck(Num <= Buffer->Capacity - Buffer->NumReadable);
+  Buffer->NumReadable += Num;
+}
+
+auto
+::RingBufferConsume(ring_buffer* Buffer, size_t Num)
+  -> void
+{
+  Assert(Buffer);
+  BoundsCheck(Num <= Buffer->NumReadable);
+  Buffer->NumReadable -= Num;
+  Buffer->ReadOffset += Num;
+  if(Buffer->ReadOffset >= Buffer->Capacity)
+    Buffer->ReadOffset -= Buffer->Capacity;
+
+  // Going back to the beginning keeps the touched pages warm.
+  if(Buffer->NumReadable == 0)
+    Buffer->ReadOffset = 0;
+}
+
+auto
+::RingBufferWrite(ring_buffer* Buffer, slice<uint8 const> Data)
+  -> size_t
+{
+  Assert(Buffer);
+  auto Free = RingBufferWritable(*Buffer);
+  auto const Num = Min(Free.Num, Data.Num);
+  MemCopyBytes(Bytes(Num), Free.Ptr, Data.Ptr);
+  RingBufferCommit(Buffer, Num);
+  return Num;
+}
+
+//]]~~
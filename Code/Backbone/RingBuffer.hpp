@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Slice.hpp"
+
+//~~[[
+
+RESERVE_PREFIX(RingBuffer);
+
+/// A byte FIFO whose readable and writable regions are always contiguous.
+///
+/// The same physical memory is mapped twice, back to back, into the address
+/// space. Whatever is written past the end of the first mapping shows up at
+/// the beginning of it, and the other way around. A region that wraps around
+/// the end of the buffer therefore is a single slice, so parsers and Slice*
+/// functions can run over streamed data without stitching pieces together.
+///
+/// Linux uses memfd_create and two fixed mmap calls. Windows maps two views of
+/// a page-file backed section next to each other.
+///
+/// Usage:
+/// \code
+/// ring_buffer Buffer;
+/// RingBufferInit(&Buffer, KiB(64));
+/// Defer [&](){ RingBufferFinalize(&Buffer); };
+///
+/// auto Free = RingBufferWritable(Buffer);
+/// auto NumRead = ReadFromSocket(Socket, Free);
+/// RingBufferCommit(&Buffer, NumRead);
+///
+/// auto Text = SliceReinterpret<char const>(RingBufferReadable(Buffer));
+/// auto LineLength = SliceCountUntil(Text, '\n');
+/// /* ... */
+/// RingBufferConsume(&Buffer, LineLength + 1);
+/// \endcode
+///
+/// Not thread-safe.
+struct ring_buffer
+{
+  /// The first of the two mappings. The second one follows at
+  /// Data + Capacity.
+  uint8* Data;
+
+  /// The size of one mapping, a multiple of the mapping granularity of the
+  /// OS.
+  size_t Capacity;
+
+  /// Offset of the first readable byte. Always less than Capacity.
+  size_t ReadOffset;
+
+  /// The number of readable bytes.
+  size_t NumReadable;
+};
+
+/// Initialize the ring buffer with at least MinCapacity bytes.
+///
+/// The capacity is rounded up to a multiple of the page size (Windows: the
+/// allocation granularity, usually 64 KiB).
+///
+/// \return \c false if the memory could not be mapped.
+bool
+RingBufferInit(ring_buffer* Buffer, memory_size MinCapacity);
+
+/// Unmap the memory and reset the ring buffer to an uninitialized state.
+void
+RingBufferFinalize(ring_buffer* Buffer);
+
+/// All bytes that were committed but not consumed yet, oldest first.
+slice<uint8>
+RingBufferReadable(ring_buffer const& Buffer);
+
+/// The free space after the readable bytes.
+///
+/// Write into it and call RingBufferCommit to make the bytes readable.
+slice<uint8>
+RingBufferWritable(ring_buffer const& Buffer);
+
+/// Append Num bytes that were written to the front of RingBufferWritable to
+/// the readable bytes.
+void
+RingBufferCommit(ring_buffer* Buffer, size_t Num);
+
+/// Drop Num bytes from the front of the readable bytes.
+void
+RingBufferConsume(ring_buffer* Buffer, size_t Num);
+
+/// Copy as many bytes of Data into the ring buffer as fit.
+///
+/// \return The number of bytes copied.
+size_t
+RingBufferWrite(ring_buffer* Buffer, slice<uint8 const> Data);
+
+//]]~~
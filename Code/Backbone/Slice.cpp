@@ -1,6 +1,10 @@
 
 #include "Slice.hpp"
 
+#if defined(BB_Platform_x64)
+  #include <immintrin.h>
+#endif
+
 //~~[[
 
 auto
@@ -25,4 +29,90 @@ auto
   return Result;
 }
 
+#if defined(BB_Platform_x64)
+
+// The byte swap kernels shuffle the bytes of each 16 byte lane according to
+// Mask. They return how many bytes they processed, always a multiple of 16.
+
+BB_TargetFeatures("avx2")
+static size_t
+SliceByteSwapAVX2(size_t NumBytes, uint8* Data, uint8 const* Mask)
+{
+  auto const Shuffle = _mm256_broadcastsi128_si256(_mm_loadu_si128(Reinterpret<__m128i const*>(Mask)));
+  size_t Offset = 0;
+  for(; Offset + 64 <= NumBytes; Offset += 64)
+  {
+    auto const Ptr = Reinterpret<__m256i*>(Data + Offset);
+    auto const A = _mm256_shuffle_epi8(_mm256_loadu_si256(Ptr + 0), Shuffle);
+    auto const B = _mm256_shuffle_epi8(_mm256_loadu_si256(Ptr + 1), Shuffle);
+    _mm256_storeu_si256(Ptr + 0, A);
+    _mm256_storeu_si256(Ptr + 1, B);
+  }
+  for(; Offset + 16 <= NumBytes; Offset += 16)
+  {
+    auto const Ptr = Reinterpret<__m128i*>(Data + Offset);
+    _mm_storeu_si128(Ptr, _mm_shuffle_epi8(_mm_loadu_si128(Ptr), _mm256_castsi256_si128(Shuffle)));
+  }
+  return Offset;
+}
+
+BB_TargetFeatures("ssse3")
+static size_t
+SliceByteSwapSSSE3(size_t NumBytes, uint8* Data, uint8 const* Mask)
+{
+  auto const Shuffle = _mm_loadu_si128(Reinterpret<__m128i const*>(Mask));
+  size_t Offset = 0;
+  for(; Offset + 16 <= NumBytes; Offset += 16)
+  {
+    auto const Ptr = Reinterpret<__m128i*>(Data + Offset);
+    _mm_storeu_si128(Ptr, _mm_shuffle_epi8(_mm_loadu_si128(Ptr), Shuffle));
+  }
+  return Offset;
+}
+
+#endif
+
+template<typename T>
+static void
+SliceByteSwapElements(slice<T> Values, uint8 const (&Mask)[16])
+{
+  size_t NumSwapped = 0;
+
+#if defined(BB_Platform_x64)
+  auto const Data = Reinterpret<uint8*>(Values.Ptr);
+  auto const NumBytes = Values.Num * sizeof(T);
+  if(CpuHasFeature(Cpu_AVX2))
+    NumSwapped = SliceByteSwapAVX2(NumBytes, Data, Mask) / sizeof(T);
+  else if(CpuHasFeature(Cpu_SSSE3))
+    NumSwapped = SliceByteSwapSSSE3(NumBytes, Data, Mask) / sizeof(T);
+#endif
+
+  for(size_t Index = NumSwapped; Index < Values.Num; ++Index)
+    Values.Ptr[Index] = ByteSwap(Values.Ptr[Index]);
+}
+
+auto
+::SliceByteSwap(slice<uint16> Values)
+  -> void
+{
+  static uint8 const Mask[16] = { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+  SliceByteSwapElements(Values, Mask);
+}
+
+auto
+::SliceByteSwap(slice<uint32> Values)
+  -> void
+{
+  static uint8 const Mask[16] = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+  SliceByteSwapElements(Values, Mask);
+}
+
+auto
+::SliceByteSwap(slice<uint64> Values)
+  -> void
+{
+  static uint8 const Mask[16] = { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 };
+  SliceByteSwapElements(Values, Mask);
+}
+
 //]]~~
@@ -238,7 +238,7 @@ SliceFromString(char* StringPtr);
 
 /// Custom string literal suffix.
 /// Usage: slice<char const> Foo = "Foo"_S;
-inline slice<char const>
+constexpr slice<char const>
 operator "" _S(char const* StringPtr, size_t Num) { return Slice(Num, StringPtr); }
 
 /// Creates a new slice from an existing slice.
@@ -311,6 +311,66 @@ SliceCopyConstruct(slice<T> Destination, slice<T const> Source)
   return Amount;
 }
 
+/// Like SliceCopy, but uses multiple threads for large slices.
+///
+/// \see MemCopyBytesParallel
+template<typename T>
+inline size_t
+SliceCopyParallel(slice<T> Destination, slice<T const> Source)
+{
+  static_assert(IsTriviallyCopyable<T>(), "Elements are copied in chunks of bytes.");
+  size_t const Amount = Min(Destination.Num, Source.Num);
+  MemCopyBytesParallel(Amount * SizeOf<T>(), Destination.Ptr, Source.Ptr);
+  return Amount;
+}
+
+/// Reverse the byte order of each element in Values, in place.
+///
+/// Uses AVX2 or SSSE3 if the CPU supports it.
+void
+SliceByteSwap(slice<uint16> Values);
+
+/// \copydoc SliceByteSwap(slice<uint16>)
+void
+SliceByteSwap(slice<uint32> Values);
+
+/// \copydoc SliceByteSwap(slice<uint16>)
+void
+SliceByteSwap(slice<uint64> Values);
+
+template<size_t N> struct impl_slice_byte_swap_type;
+template<> struct impl_slice_byte_swap_type<2> { using Type = uint16; };
+template<> struct impl_slice_byte_swap_type<4> { using Type = uint32; };
+template<> struct impl_slice_byte_swap_type<8> { using Type = uint64; };
+
+/// Reverse the byte order of each element in Values, in place.
+///
+/// Works for any element type of 2, 4 or 8 bytes, e.g. signed integers,
+/// float and double.
+template<typename T>
+inline void
+SliceByteSwap(slice<T> Values)
+{
+  using swap_type = typename impl_slice_byte_swap_type<sizeof(T)>::Type;
+  SliceByteSwap(SliceReinterpret<swap_type>(Values));
+}
+
+/// Convert each element in Values from the byte order From to the byte order
+/// To, in place.
+///
+/// Usage:
+/// \code
+/// auto Samples = SliceReinterpret<int16>(Packet);
+/// SliceConvertEndian(Samples, Endian_Big, Endian_Native);
+/// \endcode
+template<typename T>
+inline void
+SliceConvertEndian(slice<T> Values, endian From, endian To)
+{
+  if(From != To)
+    SliceByteSwap(Values);
+}
+
 template<typename T>
 inline size_t
 SliceMove(slice<T> Destination, slice<T> Source)
@@ -439,11 +499,58 @@ SliceReverseElements(slice<T> SomeSlice)
 }
 
 
+/// Whether two elements of type T are equal exactly when their bytes are.
+///
+/// Not the case for floating point numbers (-0 == +0, NaN != NaN) and for
+/// structs, which may have padding or their own operator ==.
+template<typename T> struct impl_slice_is_bitwise_comparable
+{
+  static constexpr bool Value = std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value;
+};
+template<> struct impl_slice_is_bitwise_comparable<void> { static constexpr bool Value = true; };
+
+template<typename ElementTypeA, typename ElementTypeB, bool TIsBitwiseComparable = false>
+struct impl_slice_equal
+{
+  static bool
+  Do(slice<ElementTypeA> A, slice<ElementTypeB> B)
+  {
+    auto A_ = NonVoidPtr(First(A));
+    auto B_ = NonVoidPtr(First(B));
+
+    auto NumElements = A.Num;
+    while(NumElements)
+    {
+      if(*A_ != *B_)
+        return false;
+
+      ++A_;
+      ++B_;
+      --NumElements;
+    }
+
+    return true;
+  }
+};
+
+template<typename ElementTypeA, typename ElementTypeB>
+struct impl_slice_equal<ElementTypeA, ElementTypeB, true>
+{
+  static bool
+  Do(slice<ElementTypeA> A, slice<ElementTypeB> B)
+  {
+    return MemEqualBytes(A.Num * SizeOf<ElementTypeA>(), A.Ptr, B.Ptr);
+  }
+};
+
 /// Compares the contents of the two slices for equality.
 ///
 /// Two slices are deemed equal if they have the same number of elements and
 /// each individual element in A compares equal to the corresponding element
 /// in B in the order they appear in.
+///
+/// Slices of the same integer, enum or pointer type are compared with
+/// MemEqualBytes.
 template<typename ElementTypeA, typename ElementTypeB>
 bool
 operator ==(slice<ElementTypeA> A, slice<ElementTypeB> B)
@@ -455,18 +562,10 @@ operator ==(slice<ElementTypeA> A, slice<ElementTypeB> B)
   // if(A_ == B_) return true;
   if(Coerce<size_t>(A_) == Coerce<size_t>(B_)) return true;
 
-  auto NumElements = A.Num;
-  while(NumElements)
-  {
-    if(*A_ != *B_)
-      return false;
-
-    ++A_;
-    ++B_;
-    --NumElements;
-  }
-
-  return true;
+  using element_type = rm_const<ElementTypeA>;
+  constexpr bool IsBitwiseComparable = std::is_same<element_type, rm_const<ElementTypeB>>::value &&
+                                       impl_slice_is_bitwise_comparable<element_type>::Value;
+  return impl_slice_equal<ElementTypeA, ElementTypeB, IsBitwiseComparable>::Do(A, B);
 }
 
 
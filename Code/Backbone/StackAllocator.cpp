@@ -0,0 +1,228 @@
+#include "StackAllocator.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+//~~[[
+
+/// Stored right in front of allocations that need alignment padding. Not
+/// necessarily aligned, so it is only accessed through memcpy.
+struct stack_padding_header
+{
+  /// The top of the stack before the padding.
+  size_t PreviousTop;
+
+  /// stack_allocator::LastPadded before the allocation.
+  size_t PreviousPadded;
+};
+
+static stack_padding_header
+StackReadPaddingHeader(stack_allocator const* Stack, size_t Offset)
+{
+  stack_padding_header Header;
+  std::memcpy(&Header, MemAddByteOffset(Stack->Memory.Ptr, Offset - sizeof(Header)), sizeof(Header));
+  return Header;
+}
+
+/// Release everything above NewTop.
+static void
+StackPop(stack_allocator* Stack, size_t NewTop)
+{
+  // Forget the padded allocations that are released.
+  while(Stack->LastPadded > NewTop)
+    Stack->LastPadded = StackReadPaddingHeader(Stack, Stack->LastPadded).PreviousPadded;
+
+  if(NewTop < Stack->Top)
+    AllocStatsRecordFree(Stack->Stats, Bytes(Stack->Top - NewTop));
+
+  Stack->Top = NewTop;
+}
+
+/// Release the allocation at Offset, including its alignment padding, and
+/// everything above it.
+static void
+StackFreeAt(stack_allocator* Stack, size_t Offset)
+{
+  StackPop(Stack, Offset);
+
+  if(Stack->LastPadded != 0 && Stack->LastPadded == Offset)
+  {
+    auto const Header = StackReadPaddingHeader(Stack, Offset);
+    Stack->LastPadded = Header.PreviousPadded;
+    StackPop(Stack, Header.PreviousTop);
+  }
+}
+
+auto
+::StackInit(stack_allocator* Stack, slice<void> Memory)
+  -> void
+{
+  Assert(Stack);
+  Stack->Memory = Memory;
+  Stack->Top = 0;
+  Stack->LastPadded = 0;
+  Stack->OwnsMemory = false;
+  Stack->Stats = nullptr;
+}
+
+auto
+::StackInit(stack_allocator* Stack, memory_size Capacity)
+  -> void
+{
+  Assert(Stack);
+  auto Ptr = std::malloc(ToBytes(Capacity));
+  Stack->Memory = Slice(Ptr ? Convert<size_t>(ToBytes(Capacity)) : 0, Ptr);
+  Stack->Top = 0;
+  Stack->LastPadded = 0;
+  Stack->OwnsMemory = true;
+  Stack->Stats = nullptr;
+}
+
+auto
+::StackFinalize(stack_allocator* Stack)
+  -> void
+{
+  Assert(Stack);
+  StackPop(Stack, 0);
+
+  if(Stack->OwnsMemory)
+    std::free(Stack->Memory.Ptr);
+
+  *Stack = {};
+}
+
+auto
+::StackAllocateBytes(stack_allocator* Stack, memory_size Size, size_t Alignment)
+  -> void*
+{
+  Assert(Stack);
+  Assert(IsPowerOfTwo(Alignment));
+
+  auto const Base = Reinterpret<size_t>(Stack->Memory.Ptr);
+  auto Begin = AlignUp(Base + Stack->Top, Alignment);
+  auto const IsPadded = Begin != Base + Stack->Top;
+  if(IsPadded)
+    Begin = AlignUp(Base + Stack->Top + sizeof(stack_padding_header), Alignment);
+  auto const Offset = Begin - Base;
+
+  // Compare against the remaining space, Offset + Size may wrap around.
+  if(Offset > Stack->Memory.Num || ToBytes(Size) > Stack->Memory.Num - Offset)
+    return nullptr;
+
+  auto const NewTop = Offset + Convert<size_t>(ToBytes(Size));
+
+  if(IsPadded)
+  {
+    stack_padding_header Header;
+    Header.PreviousTop = Stack->Top;
+    Header.PreviousPadded = Stack->LastPadded;
+    std::memcpy(Reinterpret<void*>(Begin - sizeof(Header)), &Header, sizeof(Header));
+    Stack->LastPadded = Offset;
+  }
+
+  // Alignment padding is accounted to the allocation.
+  AllocStatsRecordAllocation(Stack->Stats, Bytes(NewTop - Stack->Top));
+  Stack->Top = NewTop;
+  return Reinterpret<void*>(Begin);
+}
+
+auto
+::StackFree(stack_allocator* Stack, void* Ptr)
+  -> void
+{
+  Assert(Stack);
+  if(Ptr == nullptr)
+    return;
+
+  auto const Offset = Reinterpret<size_t>(Ptr) - Reinterpret<size_t>(Stack->Memory.Ptr);
+
+  // Ptr must be an allocation that is still alive.
+  Assert(Offset <= Stack->Top);
+  StackFreeAt(Stack, Offset);
+}
+
+auto
+::StackGetMarker(stack_allocator const& Stack)
+  -> stack_marker
+{
+  return { Stack.Top };
+}
+
+auto
+::StackRollback(stack_allocator* Stack, stack_marker Marker)
+  -> void
+{
+  Assert(Stack);
+
+  // Rolling forward is not allowed. This usually means the marker was
+  // recorded in an inner scope that was already rolled back.
+  Assert(Marker.Top <= Stack->Top);
+  StackPop(Stack, Marker.Top);
+}
+
+static void*
+StackAllocatorAllocate(void* Context, memory_size Size, size_t Alignment)
+{
+  return StackAllocateBytes(Reinterpret<stack_allocator*>(Context), Size, Alignment);
+}
+
+static void*
+StackAllocatorReallocate(void* Context, void* Ptr, memory_size OldSize, memory_size NewSize, size_t Alignment)
+{
+  auto Stack = Reinterpret<stack_allocator*>(Context);
+  auto const Offset = Reinterpret<size_t>(Ptr) - Reinterpret<size_t>(Stack->Memory.Ptr);
+  auto const IsTop = Offset <= Stack->Top && ToBytes(OldSize) == Stack->Top - Offset;
+
+  if(IsTop && IsAligned(Ptr, Alignment) && ToBytes(NewSize) <= Stack->Memory.Num - Offset)
+  {
+    auto const NewTop = Offset + Convert<size_t>(ToBytes(NewSize));
+    AllocStatsRecordResize(Stack->Stats, Bytes(Stack->Top), Bytes(NewTop));
+    Stack->Top = NewTop;
+    return Ptr;
+  }
+
+  auto NewPtr = StackAllocateBytes(Stack, NewSize, Alignment);
+  if(NewPtr)
+    MemCopyBytes(Min(OldSize, NewSize), NewPtr, Ptr);
+  return NewPtr;
+}
+
+static void
+StackAllocatorFree(void* Context, void* Ptr, memory_size Size)
+{
+  auto Stack = Reinterpret<stack_allocator*>(Context);
+  auto const Offset = Reinterpret<size_t>(Ptr) - Reinterpret<size_t>(Stack->Memory.Ptr);
+
+  // Generic code frees in any order, so only the top allocation is
+  // released. Everything else stays until the stack is rolled back.
+  if(Offset <= Stack->Top && ToBytes(Size) == Stack->Top - Offset)
+    StackFreeAt(Stack, Offset);
+}
+
+auto
+::AllocatorFrom(stack_allocator* Stack)
+  -> allocator
+{
+  allocator Result;
+  Result.Context = Stack;
+  Result.AllocateFunc = StackAllocatorAllocate;
+  Result.ReallocateFunc = StackAllocatorReallocate;
+  Result.FreeFunc = StackAllocatorFree;
+  return Result;
+}
+
+auto
+::StackUsed(stack_allocator const& Stack)
+  -> memory_size
+{
+  return Bytes(Stack.Top);
+}
+
+auto
+::StackCapacity(stack_allocator const& Stack)
+  -> memory_size
+{
+  return Bytes(Stack.Memory.Num);
+}
+
+//]]~~
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Memory.hpp"
+#include "Slice.hpp"
+#include "Allocator.hpp"
+#include "AllocationStats.hpp"
+
+//~~[[
+
+RESERVE_PREFIX(Stack);
+
+/// A LIFO allocator.
+///
+/// Like an arena, memory is handed out front to back from a single
+/// contiguous block. In addition, the most recent allocation can be freed
+/// and the current position can be recorded as a marker to later roll back
+/// to, releasing everything that was allocated in the meantime.
+///
+/// \see StackScope
+struct stack_allocator
+{
+  /// The memory this allocator hands out.
+  slice<void> Memory;
+
+  /// Offset of the first unused byte in Memory.
+  size_t Top;
+
+  /// Offset of the most recent live allocation that needed alignment
+  /// padding, or 0 if there is none.
+  ///
+  /// Such allocations are preceded by a small header within their padding,
+  /// which links to the one before and remembers the top of the stack before
+  /// the padding.
+  size_t LastPadded;
+
+  /// Whether Memory was allocated by the stack allocator itself.
+  bool32 OwnsMemory;
+
+  /// Where to record allocations. May be \c nullptr.
+  ///
+  /// \see allocation_stats
+  allocation_stats* Stats;
+};
+
+/// A recorded position within a stack_allocator.
+struct stack_marker
+{
+  size_t Top;
+};
+
+/// Initialize the stack allocator to hand out memory from the given buffer.
+///
+/// The stack allocator does not take ownership of Memory.
+void
+StackInit(stack_allocator* Stack, slice<void> Memory);
+
+/// Initialize the stack allocator with a buffer of the given capacity
+/// allocated from the heap. That buffer is freed again in StackFinalize.
+void
+StackInit(stack_allocator* Stack, memory_size Capacity);
+
+/// Release the memory owned by the stack allocator, if any, and reset it to
+/// an uninitialized state.
+void
+StackFinalize(stack_allocator* Stack);
+
+/// Allocate Size bytes with the given Alignment on top of the stack.
+///
+/// If the top of the stack is not aligned already, the padding is made large
+/// enough to hold a header of two size_t.
+///
+/// \param Alignment Must be a power of two.
+/// \return \c nullptr if the stack has not enough memory left.
+void*
+StackAllocateBytes(stack_allocator* Stack, memory_size Size, size_t Alignment);
+
+/// Free the allocation at Ptr and everything that was allocated after it.
+///
+/// The alignment padding in front of Ptr is released as well, so the stack
+/// is back where it was before the allocation.
+///
+/// In the intended use, Ptr is the most recent allocation.
+void
+StackFree(stack_allocator* Stack, void* Ptr);
+
+/// Record the current top of the stack.
+stack_marker
+StackGetMarker(stack_allocator const& Stack);
+
+/// Free everything that was allocated after Marker was recorded.
+void
+StackRollback(stack_allocator* Stack, stack_marker Marker);
+
+/// The number of bytes currently in use, including alignment padding.
+memory_size
+StackUsed(stack_allocator const& Stack);
+
+/// The total amount of memory the stack allocator manages.
+memory_size
+StackCapacity(stack_allocator const& Stack);
+
+/// Get an allocator that allocates from the given stack allocator.
+///
+/// Freeing through that allocator only releases the allocation on top of the
+/// stack, anything else is released on the next rollback. Reallocating the
+/// allocation on top of the stack resizes it in place.
+allocator
+AllocatorFrom(stack_allocator* Stack);
+
+/// Allocate Num elements of type T on top of the stack and construct them
+/// with Args.
+///
+/// \see MemConstruct
+/// \return An empty slice if the stack has not enough memory left.
+template<typename T, typename... ArgTypes>
+slice<T>
+StackAllocate(stack_allocator* Stack, size_t Num, ArgTypes&&... Args)
+{
+  if(Num > IntMaxValue<size_t>() / sizeof(T))
+    return {};
+
+  auto Ptr = Reinterpret<T*>(StackAllocateBytes(Stack, Num * SizeOf<T>(), alignof(T)));
+  if(Ptr == nullptr)
+    return {};
+
+  MemConstruct(Num, Ptr, Forward<ArgTypes>(Args)...);
+  return Slice(Num, Ptr);
+}
+
+/// Roll back the given stack allocator at the end of the current scope.
+///
+/// Everything allocated from the stack after this statement is released
+/// when the scope is left. No destructors are called.
+///
+/// Usage:
+/// \code
+/// void Foo(stack_allocator* Stack)
+/// {
+///   StackScope(Stack);
+///   auto Buffer = StackAllocate<char>(Stack, 256);
+///   auto Path = ConcatPaths("Foo"_S, "Bar"_S, Buffer);
+///   /* ... */
+/// } // Buffer is released here.
+/// \endcode
+#define StackScope(Stack) \
+  auto PRE_Concat2(_StackScope, __LINE__) = (Stack); \
+  auto PRE_Concat2(_StackMarker, __LINE__) = StackGetMarker(*PRE_Concat2(_StackScope, __LINE__)); \
+  Defer [=](){ StackRollback(PRE_Concat2(_StackScope, __LINE__), PRE_Concat2(_StackMarker, __LINE__)); }
+
+//]]~~
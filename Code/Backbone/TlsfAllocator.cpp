@@ -0,0 +1,407 @@
+#include "TlsfAllocator.hpp"
+
+#include <cstddef>
+
+//~~[[
+
+/// Placed right in front of every block in the managed memory.
+struct impl_tlsf_block
+{
+  /// The block in front of this one, \c nullptr for the first block.
+  impl_tlsf_block* PrevPhysical;
+
+  /// The payload size in the upper bits, TlsfFreeFlag in the lowest bit.
+  size_t SizeAndFlags;
+
+  // Only valid while the block is free. Overlaps the payload.
+  impl_tlsf_block* NextFree;
+  impl_tlsf_block* PrevFree;
+};
+
+static size_t const TlsfFreeFlag = 1;
+
+/// The distance from the beginning of a block to its payload.
+static size_t const TlsfHeaderSize = Tlsf_Alignment;
+
+/// Every block must be able to hold the free list links.
+static size_t const TlsfMinPayloadSize = Tlsf_Alignment;
+static size_t const TlsfMinBlockSize = TlsfHeaderSize + TlsfMinPayloadSize;
+
+/// Blocks must stay below the size of the last first-level class.
+static uint64 const TlsfMaxPayloadSize = (uint64(1) << (Tlsf_FirstLevelCount + Tlsf_FirstLevelShift - 1)) - Tlsf_Alignment;
+
+static_assert(offsetof(impl_tlsf_block, NextFree) <= TlsfHeaderSize, "The block header must fit in front of the payload.");
+static_assert(sizeof(impl_tlsf_block) <= TlsfMinBlockSize, "The free list links must fit into the smallest payload.");
+
+static size_t
+TlsfSize(impl_tlsf_block const* Block)
+{
+  return Block->SizeAndFlags & ~TlsfFreeFlag;
+}
+
+static bool
+TlsfIsFree(impl_tlsf_block const* Block)
+{
+  return (Block->SizeAndFlags & TlsfFreeFlag) != 0;
+}
+
+static void
+TlsfSetSize(impl_tlsf_block* Block, size_t Size)
+{
+  Block->SizeAndFlags = Size | (Block->SizeAndFlags & TlsfFreeFlag);
+}
+
+static void
+TlsfSetFree(impl_tlsf_block* Block, bool IsFree)
+{
+  Block->SizeAndFlags = TlsfSize(Block) | (IsFree ? TlsfFreeFlag : 0);
+}
+
+static void*
+TlsfPayload(impl_tlsf_block* Block)
+{
+  return MemAddByteOffset(Block, TlsfHeaderSize);
+}
+
+static impl_tlsf_block*
+TlsfBlockOf(void* Payload)
+{
+  return Reinterpret<impl_tlsf_block*>(Reinterpret<uint8*>(Payload) - TlsfHeaderSize);
+}
+
+static impl_tlsf_block*
+TlsfNextPhysical(impl_tlsf_block* Block)
+{
+  return Reinterpret<impl_tlsf_block*>(MemAddByteOffset(Block, TlsfHeaderSize + TlsfSize(Block)));
+}
+
+/// The free list a block of the given Size belongs to.
+static void
+TlsfMapping(size_t Size, uint32* Out_FirstLevel, uint32* Out_SecondLevel)
+{
+  if(Size < Tlsf_SmallBlockSize)
+  {
+    *Out_FirstLevel = 0;
+    *Out_SecondLevel = Convert<uint32>(Size / (Tlsf_SmallBlockSize / Tlsf_SecondLevelCount));
+  }
+  else
+  {
+    auto const Log2 = FindLastSetBit(Size);
+    *Out_FirstLevel = Log2 - (Tlsf_FirstLevelShift - 1);
+    *Out_SecondLevel = Convert<uint32>(Size >> (Log2 - Tlsf_SecondLevelLog2)) ^ Tlsf_SecondLevelCount;
+  }
+}
+
+/// Find a non-empty free list whose blocks are all at least as big as the
+/// given list. Two bit-scans at most.
+static impl_tlsf_block*
+TlsfFindSuitableBlock(tlsf_allocator const& Tlsf, uint32 FirstLevel, uint32 SecondLevel)
+{
+  auto SecondLevelMap = Tlsf.SecondLevelBitmaps[FirstLevel] & (~uint32(0) << SecondLevel);
+  if(SecondLevelMap == 0)
+  {
+    // Look in the next bigger first-level classes.
+    auto const FirstLevelMap = Convert<uint32>(Tlsf.FirstLevelBitmap & (~uint64(0) << (FirstLevel + 1)));
+    if(FirstLevelMap == 0)
+      return nullptr;
+
+    FirstLevel = FindFirstSetBit(FirstLevelMap);
+    SecondLevelMap = Tlsf.SecondLevelBitmaps[FirstLevel];
+  }
+
+  return Tlsf.FreeLists[FirstLevel][FindFirstSetBit(SecondLevelMap)];
+}
+
+static void
+TlsfInsertFreeBlock(tlsf_allocator* Tlsf, impl_tlsf_block* Block)
+{
+  uint32 FirstLevel, SecondLevel;
+  TlsfMapping(TlsfSize(Block), &FirstLevel, &SecondLevel);
+
+  auto& Head = Tlsf->FreeLists[FirstLevel][SecondLevel];
+  Block->NextFree = Head;
+  Block->PrevFree = nullptr;
+  if(Head) Head->PrevFree = Block;
+  Head = Block;
+
+  TlsfSetFree(Block, true);
+  Tlsf->FirstLevelBitmap = SetBit(Tlsf->FirstLevelBitmap, FirstLevel);
+  Tlsf->SecondLevelBitmaps[FirstLevel] = SetBit(Tlsf->SecondLevelBitmaps[FirstLevel], SecondLevel);
+}
+
+static void
+TlsfRemoveFreeBlock(tlsf_allocator* Tlsf, impl_tlsf_block* Block)
+{
+  uint32 FirstLevel, SecondLevel;
+  TlsfMapping(TlsfSize(Block), &FirstLevel, &SecondLevel);
+
+  auto& Head = Tlsf->FreeLists[FirstLevel][SecondLevel];
+  if(Block->PrevFree) Block->PrevFree->NextFree = Block->NextFree;
+  else                Head = Block->NextFree;
+  if(Block->NextFree) Block->NextFree->PrevFree = Block->PrevFree;
+
+  TlsfSetFree(Block, false);
+  if(Head == nullptr)
+  {
+    Tlsf->SecondLevelBitmaps[FirstLevel] = UnsetBit(Tlsf->SecondLevelBitmaps[FirstLevel], SecondLevel);
+    if(Tlsf->SecondLevelBitmaps[FirstLevel] == 0)
+      Tlsf->FirstLevelBitmap = UnsetBit(Tlsf->FirstLevelBitmap, FirstLevel);
+  }
+}
+
+/// Cut Block down to Size and put the rest, if it is big enough to be a
+/// block of its own, on the free lists.
+static void
+TlsfTrimTail(tlsf_allocator* Tlsf, impl_tlsf_block* Block, size_t Size)
+{
+  auto const OldSize = TlsfSize(Block);
+  if(OldSize < Size + TlsfMinBlockSize)
+    return;
+
+  auto Rest = Reinterpret<impl_tlsf_block*>(MemAddByteOffset(Block, TlsfHeaderSize + Size));
+  Rest->PrevPhysical = Block;
+  Rest->SizeAndFlags = OldSize - Size - TlsfHeaderSize;
+  TlsfNextPhysical(Rest)->PrevPhysical = Rest;
+  TlsfSetSize(Block, Size);
+
+  // The block after Rest may be free if Block was in use before.
+  auto Next = TlsfNextPhysical(Rest);
+  if(TlsfIsFree(Next))
+  {
+    TlsfRemoveFreeBlock(Tlsf, Next);
+    TlsfSetSize(Rest, TlsfSize(Rest) + TlsfHeaderSize + TlsfSize(Next));
+    TlsfNextPhysical(Rest)->PrevPhysical = Rest;
+  }
+
+  TlsfInsertFreeBlock(Tlsf, Rest);
+}
+
+/// Cut the front of the free Block off so that the payload of the remaining
+/// block is aligned, and put the front on the free lists.
+static impl_tlsf_block*
+TlsfTrimHead(tlsf_allocator* Tlsf, impl_tlsf_block* Block, size_t Alignment)
+{
+  auto const Payload = Reinterpret<size_t>(TlsfPayload(Block));
+  auto Aligned = AlignUp(Payload, Alignment);
+  if(Aligned == Payload)
+    return Block;
+
+  // The front must be big enough to be a block of its own.
+  if(Aligned - Payload < TlsfMinBlockSize)
+    Aligned = AlignUp(Payload + TlsfMinBlockSize, Alignment);
+
+  auto const Gap = Aligned - Payload;
+  auto Rest = TlsfBlockOf(Reinterpret<void*>(Aligned));
+  Rest->PrevPhysical = Block;
+  Rest->SizeAndFlags = TlsfSize(Block) - Gap;
+  TlsfNextPhysical(Rest)->PrevPhysical = Rest;
+  TlsfSetSize(Block, Gap - TlsfHeaderSize);
+
+  // The block in front of a free block is never free, so there is nothing
+  // to merge with.
+  TlsfInsertFreeBlock(Tlsf, Block);
+  return Rest;
+}
+
+auto
+::TlsfInit(tlsf_allocator* Tlsf, slice<void> Memory)
+  -> void
+{
+  Assert(Tlsf);
+  *Tlsf = {};
+
+  auto const Begin = AlignUp(Reinterpret<size_t>(Memory.Ptr), Tlsf_Alignment);
+  auto const End = AlignDown(Reinterpret<size_t>(Memory.Ptr) + Memory.Num, Tlsf_Alignment);
+
+  // One free block spanning everything, followed by an empty block that is
+  // always in use, so merging stops at the end.
+  if(End < Begin + TlsfMinBlockSize + TlsfHeaderSize)
+    return;
+
+  auto const Size = Convert<size_t>(Min(uint64(End - Begin - 2 * TlsfHeaderSize), TlsfMaxPayloadSize));
+
+  auto First = Reinterpret<impl_tlsf_block*>(Begin);
+  First->PrevPhysical = nullptr;
+  First->SizeAndFlags = Size;
+
+  auto Sentinel = TlsfNextPhysical(First);
+  Sentinel->PrevPhysical = First;
+  Sentinel->SizeAndFlags = 0;
+
+  Tlsf->Memory = Slice(Size + 2 * TlsfHeaderSize, Reinterpret<void*>(Begin));
+  TlsfInsertFreeBlock(Tlsf, First);
+}
+
+auto
+::TlsfFinalize(tlsf_allocator* Tlsf)
+  -> void
+{
+  Assert(Tlsf);
+  if(Tlsf->UsedBytes)
+    AllocStatsRecordFree(Tlsf->Stats, Bytes(Tlsf->UsedBytes));
+
+  *Tlsf = {};
+}
+
+auto
+::TlsfAllocateBytes(tlsf_allocator* Tlsf, memory_size Size, size_t Alignment)
+  -> void*
+{
+  Assert(Tlsf);
+  Assert(IsPowerOfTwo(Alignment));
+
+  if(ToBytes(Size) > TlsfMaxPayloadSize)
+    return nullptr;
+
+  auto const PayloadSize = Max(AlignUp(Convert<size_t>(ToBytes(Size)), Tlsf_Alignment), TlsfMinPayloadSize);
+
+  // With a bigger alignment, the block may need to be cut at the front.
+  auto SearchSize = PayloadSize;
+  if(Alignment > Tlsf_Alignment)
+    SearchSize += Alignment + TlsfMinBlockSize;
+
+  // Round up to the next list, so that any block in it is big enough.
+  if(SearchSize >= Tlsf_SmallBlockSize)
+    SearchSize += (size_t(1) << (FindLastSetBit(SearchSize) - Tlsf_SecondLevelLog2)) - 1;
+
+  uint32 FirstLevel, SecondLevel;
+  TlsfMapping(SearchSize, &FirstLevel, &SecondLevel);
+  if(FirstLevel >= Tlsf_FirstLevelCount)
+    return nullptr;
+
+  auto Block = TlsfFindSuitableBlock(*Tlsf, FirstLevel, SecondLevel);
+  if(Block == nullptr)
+    return nullptr;
+
+  TlsfRemoveFreeBlock(Tlsf, Block);
+  if(Alignment > Tlsf_Alignment)
+    Block = TlsfTrimHead(Tlsf, Block, Alignment);
+  TlsfTrimTail(Tlsf, Block, PayloadSize);
+
+  Tlsf->UsedBytes += TlsfSize(Block);
+  AllocStatsRecordAllocation(Tlsf->Stats, Bytes(TlsfSize(Block)));
+  return TlsfPayload(Block);
+}
+
+auto
+::TlsfFree(tlsf_allocator* Tlsf, void* Ptr)
+  -> void
+{
+  Assert(Tlsf);
+  if(Ptr == nullptr)
+    return;
+
+  auto Block = TlsfBlockOf(Ptr);
+  Assert(!TlsfIsFree(Block)); // Double free?
+
+  Tlsf->UsedBytes -= TlsfSize(Block);
+  AllocStatsRecordFree(Tlsf->Stats, Bytes(TlsfSize(Block)));
+
+  auto Prev = Block->PrevPhysical;
+  if(Prev && TlsfIsFree(Prev))
+  {
+    TlsfRemoveFreeBlock(Tlsf, Prev);
+    TlsfSetSize(Prev, TlsfSize(Prev) + TlsfHeaderSize + TlsfSize(Block));
+    TlsfNextPhysical(Prev)->PrevPhysical = Prev;
+    Block = Prev;
+  }
+
+  auto Next = TlsfNextPhysical(Block);
+  if(TlsfIsFree(Next))
+  {
+    TlsfRemoveFreeBlock(Tlsf, Next);
+    TlsfSetSize(Block, TlsfSize(Block) + TlsfHeaderSize + TlsfSize(Next));
+    TlsfNextPhysical(Block)->PrevPhysical = Block;
+  }
+
+  TlsfInsertFreeBlock(Tlsf, Block);
+}
+
+auto
+::TlsfBlockSize(tlsf_allocator const& Tlsf, void* Ptr)
+  -> memory_size
+{
+  auto Block = TlsfBlockOf(Ptr);
+  Assert(!TlsfIsFree(Block));
+  return Bytes(TlsfSize(Block));
+}
+
+auto
+::TlsfUsed(tlsf_allocator const& Tlsf)
+  -> memory_size
+{
+  return Bytes(Tlsf.UsedBytes);
+}
+
+auto
+::TlsfCapacity(tlsf_allocator const& Tlsf)
+  -> memory_size
+{
+  return Bytes(Tlsf.Memory.Num);
+}
+
+static void*
+TlsfAllocatorAllocate(void* Context, memory_size Size, size_t Alignment)
+{
+  return TlsfAllocateBytes(Reinterpret<tlsf_allocator*>(Context), Size, Alignment);
+}
+
+static void*
+TlsfAllocatorReallocate(void* Context, void* Ptr, memory_size OldSize, memory_size NewSize, size_t Alignment)
+{
+  auto Tlsf = Reinterpret<tlsf_allocator*>(Context);
+  auto Block = TlsfBlockOf(Ptr);
+  auto const PayloadSize = Max(AlignUp(Convert<size_t>(ToBytes(NewSize)), Tlsf_Alignment), TlsfMinPayloadSize);
+
+  if(IsAligned(Ptr, Alignment))
+  {
+    auto const OldBlockSize = TlsfSize(Block);
+    if(PayloadSize > OldBlockSize)
+    {
+      // Grow into the next block if it is free and big enough.
+      auto Next = TlsfNextPhysical(Block);
+      if(TlsfIsFree(Next) && OldBlockSize + TlsfHeaderSize + TlsfSize(Next) >= PayloadSize)
+      {
+        TlsfRemoveFreeBlock(Tlsf, Next);
+        TlsfSetSize(Block, OldBlockSize + TlsfHeaderSize + TlsfSize(Next));
+        TlsfNextPhysical(Block)->PrevPhysical = Block;
+      }
+    }
+
+    if(PayloadSize <= TlsfSize(Block))
+    {
+      TlsfTrimTail(Tlsf, Block, PayloadSize);
+      Tlsf->UsedBytes = Tlsf->UsedBytes - OldBlockSize + TlsfSize(Block);
+      AllocStatsRecordResize(Tlsf->Stats, Bytes(OldBlockSize), Bytes(TlsfSize(Block)));
+      return Ptr;
+    }
+  }
+
+  auto NewPtr = TlsfAllocateBytes(Tlsf, NewSize, Alignment);
+  if(NewPtr)
+  {
+    MemCopyBytes(Min(OldSize, NewSize), NewPtr, Ptr);
+    TlsfFree(Tlsf, Ptr);
+  }
+  return NewPtr;
+}
+
+static void
+TlsfAllocatorFree(void* Context, void* Ptr, memory_size Size)
+{
+  TlsfFree(Reinterpret<tlsf_allocator*>(Context), Ptr);
+}
+
+auto
+::AllocatorFrom(tlsf_allocator* Tlsf)
+  -> allocator
+{
+  allocator Result;
+  Result.Context = Tlsf;
+  Result.AllocateFunc = TlsfAllocatorAllocate;
+  Result.ReallocateFunc = TlsfAllocatorReallocate;
+  Result.FreeFunc = TlsfAllocatorFree;
+  return Result;
+}
+
+//]]~~
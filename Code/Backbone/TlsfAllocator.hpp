@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Memory.hpp"
+#include "Slice.hpp"
+#include "Allocator.hpp"
+#include "AllocationStats.hpp"
+
+//~~[[
+
+RESERVE_PREFIX(Tlsf);
+
+enum
+{
+  /// Every block is aligned to and a multiple of this.
+  Tlsf_Alignment = 16,
+
+  /// log2 of the number of second-level lists per first-level class.
+  Tlsf_SecondLevelLog2 = 5,
+  Tlsf_SecondLevelCount = 1 << Tlsf_SecondLevelLog2,
+
+  /// Blocks below this size are spread linearly over the second-level lists
+  /// of the first class, in steps of Tlsf_Alignment.
+  Tlsf_FirstLevelShift = Tlsf_SecondLevelLog2 + 4,
+  Tlsf_SmallBlockSize = 1 << Tlsf_FirstLevelShift,
+
+  /// The number of first-level classes. Together with Tlsf_FirstLevelShift
+  /// this limits blocks to less than 2^40 bytes.
+  Tlsf_FirstLevelCount = 32,
+};
+
+struct impl_tlsf_block;
+
+/// A Two-Level Segregated Fit allocator over a single region of memory.
+///
+/// Meant for code with hard latency budgets: allocating and freeing take a
+/// bounded number of steps, independent of the number and sizes of the live
+/// allocations.
+///
+/// Free blocks are kept in segregated lists by size. The first level splits
+/// sizes into power-of-two classes, the second level splits each class
+/// linearly into Tlsf_SecondLevelCount lists. One bit per list records
+/// whether it is empty, so a bit-scan on those bitmaps finds a list with a
+/// block that is big enough without searching. Freed blocks are merged with
+/// their free neighbors right away.
+///
+/// Each block has a header of two pointers in front of it, which lives in
+/// the managed memory.
+///
+/// Not thread-safe.
+struct tlsf_allocator
+{
+  /// The managed memory, aligned to Tlsf_Alignment.
+  slice<void> Memory;
+
+  /// Bit N is set if any list of first-level class N is not empty.
+  uint32 FirstLevelBitmap;
+
+  /// Bit M of entry N is set if FreeLists[N][M] is not empty.
+  uint32 SecondLevelBitmaps[Tlsf_FirstLevelCount];
+
+  impl_tlsf_block* FreeLists[Tlsf_FirstLevelCount][Tlsf_SecondLevelCount];
+
+  /// The size of all blocks currently handed out, without headers.
+  size_t UsedBytes;
+
+  /// Where to record allocations. May be \c nullptr.
+  ///
+  /// \see allocation_stats
+  allocation_stats* Stats;
+};
+
+/// Initialize the TLSF allocator to hand out memory from the given region.
+///
+/// The allocator does not take ownership of Memory. Memory is split into a
+/// single free block, so it should be a good deal bigger than the biggest
+/// expected allocation.
+void
+TlsfInit(tlsf_allocator* Tlsf, slice<void> Memory);
+
+/// Reset the allocator to an uninitialized state.
+///
+/// Live allocations are not freed, they just become invalid.
+void
+TlsfFinalize(tlsf_allocator* Tlsf);
+
+/// Allocate Size bytes with the given Alignment.
+///
+/// \param Alignment Must be a power of two.
+/// \return \c nullptr if there is no free block big enough.
+void*
+TlsfAllocateBytes(tlsf_allocator* Tlsf, memory_size Size, size_t Alignment);
+
+/// Free the allocation at Ptr.
+///
+/// \param Ptr Must have been allocated from this TLSF allocator. May be
+///            \c nullptr.
+void
+TlsfFree(tlsf_allocator* Tlsf, void* Ptr);
+
+/// The usable size of the block at Ptr, which is at least the requested size.
+memory_size
+TlsfBlockSize(tlsf_allocator const& Tlsf, void* Ptr);
+
+/// The size of all blocks currently handed out, without headers.
+memory_size
+TlsfUsed(tlsf_allocator const& Tlsf);
+
+/// The total amount of memory the TLSF allocator manages, including headers.
+memory_size
+TlsfCapacity(tlsf_allocator const& Tlsf);
+
+/// Get an allocator that allocates from the given TLSF allocator.
+///
+/// Reallocating grows in place if the block that follows is free.
+allocator
+AllocatorFrom(tlsf_allocator* Tlsf);
+
+/// Allocate Num elements of type T and construct them with Args.
+///
+/// \see MemConstruct
+/// \return An empty slice if there is no free block big enough.
+template<typename T, typename... ArgTypes>
+slice<T>
+TlsfAllocate(tlsf_allocator* Tlsf, size_t Num, ArgTypes&&... Args)
+{
+  if(Num > IntMaxValue<size_t>() / sizeof(T))
+    return {};
+
+  auto Ptr = Reinterpret<T*>(TlsfAllocateBytes(Tlsf, Num * SizeOf<T>(), alignof(T)));
+  if(Ptr == nullptr)
+    return {};
+
+  MemConstruct(Num, Ptr, Forward<ArgTypes>(Args)...);
+  return Slice(Num, Ptr);
+}
+
+//]]~~
@@ -0,0 +1,209 @@
+#include "VirtualMemory.hpp"
+
+#if defined(BB_Platform_Windows)
+  #include <windows.h>
+#elif defined(BB_Platform_Linux)
+  #include <sys/mman.h>
+  #include <unistd.h>
+  #include <cstdio>
+  #include <cstring>
+#endif
+
+//~~[[
+
+#if defined(BB_Platform_Windows)
+
+auto
+::VirtualMemPageSize()
+  -> memory_size
+{
+  SYSTEM_INFO SystemInfo;
+  GetSystemInfo(&SystemInfo);
+  return Bytes(SystemInfo.dwPageSize);
+}
+
+auto
+::VirtualMemHugePageSize()
+  -> memory_size
+{
+  auto const LargePageSize = GetLargePageMinimum();
+  return LargePageSize ? Bytes(LargePageSize) : MiB(2);
+}
+
+auto
+::VirtualMemReserve(memory_size Size)
+  -> void*
+{
+  return VirtualAlloc(nullptr, ToBytes(Size), MEM_RESERVE, PAGE_NOACCESS);
+}
+
+auto
+::VirtualMemReserve(memory_size Size, virtual_mem_page_mode PageMode, virtual_mem_page_mode* Out_PageMode)
+  -> void*
+{
+  // Large pages on Windows require the "Lock pages in memory" privilege and
+  // have to be committed together with the reservation, which doesn't fit
+  // the reserve/commit model here. Always use normal pages.
+  if(Out_PageMode)
+    *Out_PageMode = VirtualMem_NormalPages;
+
+  return VirtualMemReserve(Size);
+}
+
+auto
+::VirtualMemCommit(void* Ptr, memory_size Size)
+  -> bool
+{
+  return VirtualAlloc(Ptr, ToBytes(Size), MEM_COMMIT, PAGE_READWRITE) != nullptr;
+}
+
+auto
+::VirtualMemDecommit(void* Ptr, memory_size Size)
+  -> void
+{
+  VirtualFree(Ptr, ToBytes(Size), MEM_DECOMMIT);
+}
+
+auto
+::VirtualMemRelease(void* Ptr, memory_size Size)
+  -> void
+{
+  // Windows wants a size of 0 when releasing a whole reservation.
+  VirtualFree(Ptr, 0, MEM_RELEASE);
+}
+
+#elif defined(BB_Platform_Linux)
+
+auto
+::VirtualMemPageSize()
+  -> memory_size
+{
+  return Bytes(sysconf(_SC_PAGESIZE));
+}
+
+auto
+::VirtualMemHugePageSize()
+  -> memory_size
+{
+  return MiB(2);
+}
+
+auto
+::VirtualMemReserve(memory_size Size)
+  -> void*
+{
+  // MAP_NORESERVE keeps the reservation out of the commit charge. Making
+  // pages accessible with mprotect later doesn't charge them either, so
+  // committed memory is not accounted and running out of it only shows when
+  // a page is first touched.
+  auto Ptr = mmap(nullptr, ToBytes(Size), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  return Ptr == MAP_FAILED ? nullptr : Ptr;
+}
+
+/// Whether the kernel would ever back a range with transparent huge pages
+/// after madvise(MADV_HUGEPAGE).
+static bool
+VirtualMemTransparentHugePagesEnabled()
+{
+  auto File = std::fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+  if(File == nullptr)
+    return false;
+
+  // The active setting is enclosed in brackets, e.g. "always [madvise] never".
+  char Buffer[128] = {};
+  std::fread(Buffer, 1, sizeof(Buffer) - 1, File);
+  std::fclose(File);
+  return std::strstr(Buffer, "[never]") == nullptr && std::strchr(Buffer, '[') != nullptr;
+}
+
+/// Reserve address space aligned to the huge page size, so the kernel can
+/// back it with transparent huge pages.
+static void*
+VirtualMemReserveTransparentHuge(memory_size Size)
+{
+  auto const HugePageSize = Convert<size_t>(ToBytes(VirtualMemHugePageSize()));
+  auto const TotalSize = Convert<size_t>(ToBytes(Size)) + HugePageSize;
+  auto Base = VirtualMemReserve(Bytes(TotalSize));
+  if(Base == nullptr)
+    return nullptr;
+
+  // Trim the excess on both ends.
+  auto Ptr = AlignUp(Base, HugePageSize);
+  auto const Head = Reinterpret<size_t>(Ptr) - Reinterpret<size_t>(Base);
+  auto const Tail = TotalSize - Head - Convert<size_t>(ToBytes(Size));
+  if(Head > 0)
+    munmap(Base, Head);
+  if(Tail > 0)
+    munmap(MemAddByteOffset(Ptr, ToBytes(Size)), Tail);
+
+  if(madvise(Ptr, ToBytes(Size), MADV_HUGEPAGE) != 0)
+  {
+    VirtualMemRelease(Ptr, Size);
+    return nullptr;
+  }
+
+  return Ptr;
+}
+
+auto
+::VirtualMemReserve(memory_size Size, virtual_mem_page_mode PageMode, virtual_mem_page_mode* Out_PageMode)
+  -> void*
+{
+  void* Ptr = nullptr;
+  auto UsedPageMode = VirtualMem_NormalPages;
+
+  if(PageMode == VirtualMem_ExplicitHugePages && IsAligned(Size, Convert<size_t>(ToBytes(VirtualMemHugePageSize()))))
+  {
+    // Without MAP_NORESERVE the huge pages are taken from the pool right
+    // away, so this fails cleanly instead of crashing on first access when
+    // the pool is exhausted.
+    Ptr = mmap(nullptr, ToBytes(Size), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if(Ptr == MAP_FAILED)
+      Ptr = nullptr;
+    else
+      UsedPageMode = VirtualMem_ExplicitHugePages;
+  }
+
+  if(Ptr == nullptr && PageMode != VirtualMem_NormalPages && VirtualMemTransparentHugePagesEnabled())
+  {
+    Ptr = VirtualMemReserveTransparentHuge(Size);
+    if(Ptr)
+      UsedPageMode = VirtualMem_TransparentHugePages;
+  }
+
+  if(Ptr == nullptr)
+    Ptr = VirtualMemReserve(Size);
+
+  if(Out_PageMode)
+    *Out_PageMode = UsedPageMode;
+
+  return Ptr;
+}
+
+auto
+::VirtualMemCommit(void* Ptr, memory_size Size)
+  -> bool
+{
+  return mprotect(Ptr, ToBytes(Size), PROT_READ | PROT_WRITE) == 0;
+}
+
+auto
+::VirtualMemDecommit(void* Ptr, memory_size Size)
+  -> void
+{
+  // MADV_DONTNEED drops the pages immediately. They read back as zeroes
+  // once committed again.
+  madvise(Ptr, ToBytes(Size), MADV_DONTNEED);
+  mprotect(Ptr, ToBytes(Size), PROT_NONE);
+}
+
+auto
+::VirtualMemRelease(void* Ptr, memory_size Size)
+  -> void
+{
+  munmap(Ptr, ToBytes(Size));
+}
+
+#endif
+
+//]]~~
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Common.hpp"
+
+//~~[[
+
+/// \defgroup Virtual memory functions
+///
+/// Thin wrappers around the virtual memory API of the operating system.
+///
+/// Address space is first reserved, which makes it unavailable to others
+/// without backing it with physical memory. Pages within a reserved range
+/// are then committed to make them usable and may be decommitted again to
+/// give the physical memory back to the OS while keeping the reservation.
+///
+/// All sizes and addresses given to these functions should be multiples of
+/// VirtualMemPageSize().
+///
+/// @{
+
+RESERVE_PREFIX(VirtualMem);
+
+/// What kind of pages back a reservation.
+enum virtual_mem_page_mode
+{
+  /// Regular pages of VirtualMemPageSize().
+  VirtualMem_NormalPages,
+
+  /// Regular pages that the OS is asked to promote to huge pages when
+  /// possible (Linux: madvise(MADV_HUGEPAGE)).
+  VirtualMem_TransparentHugePages,
+
+  /// Pages of VirtualMemHugePageSize() from the system's huge page pool
+  /// (Linux: MAP_HUGETLB). These are taken from the pool for the whole
+  /// reservation up front and are never given back by VirtualMemDecommit.
+  VirtualMem_ExplicitHugePages,
+
+  VirtualMem_NumPageModes,
+};
+
+/// The granularity with which memory is committed and decommitted.
+memory_size
+VirtualMemPageSize();
+
+/// The size of a huge page, usually MiB(2).
+memory_size
+VirtualMemHugePageSize();
+
+/// Reserve a range of address space of the given Size.
+///
+/// The memory is not accessible until it is committed.
+///
+/// \return \c nullptr on failure.
+void*
+VirtualMemReserve(memory_size Size);
+
+/// Reserve a range of address space of the given Size backed by huge pages.
+///
+/// If the requested PageMode is not available, this silently falls back to
+/// the next best mode, i.e. from explicit to transparent huge pages and from
+/// there to normal pages.
+///
+/// \param Size Should be a multiple of VirtualMemHugePageSize().
+/// \param Out_PageMode Receives the mode that is actually used. May be
+///                     \c nullptr.
+/// \return \c nullptr on failure.
+void*
+VirtualMemReserve(memory_size Size, virtual_mem_page_mode PageMode, virtual_mem_page_mode* Out_PageMode);
+
+/// Make the given range within a reservation readable and writable.
+///
+/// Freshly committed memory is zero-initialized.
+///
+/// On Linux, committed memory is not accounted. This succeeds as long as the
+/// range is valid, and physical memory is only assigned when a page is first
+/// touched, so running out of it surfaces there, e.g. through the OOM killer.
+///
+/// \return \c false on failure, e.g. if the system is out of memory.
+bool
+VirtualMemCommit(void* Ptr, memory_size Size);
+
+/// Give the physical memory of the given range back to the OS.
+///
+/// The range stays reserved and may be committed again later.
+void
+VirtualMemDecommit(void* Ptr, memory_size Size);
+
+/// Release a reservation that was obtained with VirtualMemReserve.
+///
+/// \param Size Must be the same size that was passed to VirtualMemReserve.
+void
+VirtualMemRelease(void* Ptr, memory_size Size);
+
+/// @}
+
+//]]~~
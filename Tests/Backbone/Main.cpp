@@ -5,5 +5,17 @@
 #include <Backbone/Common.cpp>
 #include <Backbone/Slice.cpp>
 #include <Backbone/Memory.cpp>
+#include <Backbone/AllocationStats.cpp>
+#include <Backbone/Allocator.cpp>
 #include <Backbone/Angle.cpp>
 #include <Backbone/StringConversion.cpp>
+#include <Backbone/Arena.cpp>
+#include <Backbone/StackAllocator.cpp>
+#include <Backbone/Pool.cpp>
+#include <Backbone/VirtualMemory.cpp>
+#include <Backbone/Heap.cpp>
+#include <Backbone/BuddyAllocator.cpp>
+#include <Backbone/TlsfAllocator.cpp>
+#include <Backbone/MappedFile.cpp>
+#include <Backbone/RingBuffer.cpp>
+#include <Backbone/Hash.cpp>
@@ -0,0 +1,233 @@
+#include <Backbone/AllocationStats.hpp>
+#include <Backbone/Arena.hpp>
+#include <Backbone/StackAllocator.hpp>
+#include <Backbone/Pool.hpp>
+#include <Backbone/Heap.hpp>
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+TEST_CASE("Allocation stats counters", "[AllocationStats]")
+{
+  allocation_stats Stats;
+  AllocStatsInit(&Stats);
+
+  auto Snapshot = AllocStatsSnapshot(Stats);
+  REQUIRE( Snapshot.LiveSize == Bytes(0) );
+  REQUIRE( Snapshot.PeakSize == Bytes(0) );
+  REQUIRE( Snapshot.NumAllocations == 0 );
+
+  AllocStatsRecordAllocation(&Stats, Bytes(100));
+  AllocStatsRecordAllocation(&Stats, Bytes(16));
+  AllocStatsRecordFree(&Stats, Bytes(100));
+  AllocStatsRecordAllocation(&Stats, KiB(1));
+
+  Snapshot = AllocStatsSnapshot(Stats);
+  REQUIRE( Snapshot.LiveSize == Bytes(16) + KiB(1) );
+  REQUIRE( Snapshot.PeakSize == Bytes(16) + KiB(1) );
+  REQUIRE( Snapshot.TotalAllocatedSize == Bytes(116) + KiB(1) );
+  REQUIRE( Snapshot.NumAllocations == 3 );
+  REQUIRE( Snapshot.NumFrees == 1 );
+  REQUIRE( Snapshot.SizeHistogram[AllocStatsHistogramBucket(Bytes(16))] == 1 );
+  REQUIRE( Snapshot.SizeHistogram[AllocStatsHistogramBucket(Bytes(100))] == 1 );
+  REQUIRE( Snapshot.SizeHistogram[AllocStatsHistogramBucket(KiB(1))] == 1 );
+
+  AllocStatsRecordResize(&Stats, Bytes(16), Bytes(48));
+  Snapshot = AllocStatsSnapshot(Stats);
+  REQUIRE( Snapshot.LiveSize == Bytes(48) + KiB(1) );
+  REQUIRE( Snapshot.NumAllocations == 3 );
+
+  // Recording into nothing is fine.
+  AllocStatsRecordAllocation(nullptr, Bytes(1));
+  AllocStatsRecordFree(nullptr, Bytes(1));
+}
+
+TEST_CASE("Allocation stats histogram buckets", "[AllocationStats]")
+{
+  REQUIRE( AllocStatsHistogramBucket(Bytes(0)) == 0 );
+  REQUIRE( AllocStatsHistogramBucket(Bytes(16)) == 0 );
+  REQUIRE( AllocStatsHistogramBucket(Bytes(17)) == 1 );
+  REQUIRE( AllocStatsHistogramBucket(Bytes(32)) == 1 );
+  REQUIRE( AllocStatsHistogramBucket(GiB(1)) == AllocStats_NumHistogramBuckets - 1 );
+
+  for(size_t Bucket = 0; Bucket < AllocStats_NumHistogramBuckets; ++Bucket)
+    REQUIRE( AllocStatsHistogramBucket(AllocStatsHistogramBucketLimit(Bucket)) == Bucket );
+}
+
+TEST_CASE("Allocation stats peak", "[AllocationStats]")
+{
+  allocation_stats Stats;
+  AllocStatsInit(&Stats);
+
+  SECTION("Below the granularity")
+  {
+    AllocStatsRecordAllocation(&Stats, KiB(10));
+    AllocStatsRecordAllocation(&Stats, KiB(20));
+    AllocStatsRecordFree(&Stats, KiB(10));
+    AllocStatsRecordFree(&Stats, KiB(20));
+
+    auto Snapshot = AllocStatsSnapshot(Stats);
+    REQUIRE( Snapshot.LiveSize == Bytes(0) );
+    REQUIRE( Snapshot.PeakSize == KiB(30) );
+  }
+
+  SECTION("Above the granularity")
+  {
+    for(int Index = 0; Index < 100; ++Index)
+      AllocStatsRecordAllocation(&Stats, KiB(10));
+    for(int Index = 0; Index < 100; ++Index)
+      AllocStatsRecordFree(&Stats, KiB(10));
+    AllocStatsRecordAllocation(&Stats, KiB(1));
+
+    auto Snapshot = AllocStatsSnapshot(Stats);
+    REQUIRE( Snapshot.LiveSize == KiB(1) );
+    REQUIRE( Snapshot.PeakSize == KiB(1000) );
+  }
+}
+
+TEST_CASE("Allocation stats from multiple threads", "[AllocationStats]")
+{
+  allocation_stats Stats;
+  AllocStatsInit(&Stats);
+
+  size_t const NumThreads = 8;
+  size_t const NumAllocationsPerThread = 10000;
+
+  std::vector<std::thread> Threads;
+  for(size_t ThreadIndex = 0; ThreadIndex < NumThreads; ++ThreadIndex)
+  {
+    Threads.emplace_back([&]()
+    {
+      for(size_t Index = 0; Index < NumAllocationsPerThread; ++Index)
+        AllocStatsRecordAllocation(&Stats, Bytes(64));
+      for(size_t Index = 0; Index < NumAllocationsPerThread / 2; ++Index)
+        AllocStatsRecordFree(&Stats, Bytes(64));
+    });
+  }
+  for(auto& Thread : Threads) Thread.join();
+
+  auto Snapshot = AllocStatsSnapshot(Stats);
+  REQUIRE( Snapshot.NumAllocations == NumThreads * NumAllocationsPerThread );
+  REQUIRE( Snapshot.NumFrees == NumThreads * NumAllocationsPerThread / 2 );
+  REQUIRE( Snapshot.LiveSize == Bytes(64) * (NumThreads * NumAllocationsPerThread / 2) );
+  REQUIRE( Snapshot.PeakSize >= Snapshot.LiveSize );
+  REQUIRE( Snapshot.PeakSize <= Snapshot.TotalAllocatedSize );
+}
+
+TEST_CASE("Allocators record stats", "[AllocationStats]")
+{
+  allocation_stats Stats;
+  AllocStatsInit(&Stats);
+
+  SECTION("Arena")
+  {
+    arena Arena;
+    ArenaInit(&Arena, KiB(4));
+    Arena.Stats = &Stats;
+    Defer [&](){ ArenaFinalize(&Arena); };
+
+    ArenaAllocateBytes(&Arena, Bytes(100), 1);
+    ArenaAllocateBytes(&Arena, Bytes(200), 1);
+    REQUIRE( AllocStatsSnapshot(Stats).LiveSize == Bytes(300) );
+
+    ArenaReset(&Arena);
+    auto Snapshot = AllocStatsSnapshot(Stats);
+    REQUIRE( Snapshot.LiveSize == Bytes(0) );
+    REQUIRE( Snapshot.PeakSize == Bytes(300) );
+    REQUIRE( Snapshot.NumAllocations == 2 );
+  }
+
+  SECTION("Stack allocator")
+  {
+    stack_allocator Stack;
+    StackInit(&Stack, KiB(4));
+    Stack.Stats = &Stats;
+    Defer [&](){ StackFinalize(&Stack); };
+
+    {
+      StackScope(&Stack);
+      StackAllocateBytes(&Stack, Bytes(64), 1);
+      REQUIRE( AllocStatsSnapshot(Stats).LiveSize == Bytes(64) );
+    }
+
+    REQUIRE( AllocStatsSnapshot(Stats).LiveSize == Bytes(0) );
+  }
+
+  SECTION("Pool")
+  {
+    pool<uint64> Pool;
+    PoolInit(&Pool);
+    Pool.Stats = &Stats;
+    Defer [&](){ PoolFinalize(&Pool); };
+
+    auto A = PoolCreate(&Pool);
+    PoolCreate(&Pool);
+    PoolDestroy(&Pool, A);
+
+    auto Snapshot = AllocStatsSnapshot(Stats);
+    REQUIRE( Snapshot.LiveSize == Bytes(8) );
+    REQUIRE( Snapshot.NumAllocations == 2 );
+    REQUIRE( Snapshot.NumFrees == 1 );
+  }
+
+  SECTION("Heap")
+  {
+    heap Heap;
+    HeapInit(&Heap, MiB(4));
+    Heap.Stats = &Stats;
+    Defer [&](){ HeapFinalize(&Heap); };
+
+    auto Small = HeapAllocate(&Heap, Bytes(20), 1);
+    auto Large = HeapAllocate(&Heap, KiB(10), 16);
+    REQUIRE( AllocStatsSnapshot(Stats).LiveSize == Bytes(32) + KiB(10) );
+
+    HeapFree(&Heap, Small);
+    HeapFree(&Heap, Large);
+    REQUIRE( AllocStatsSnapshot(Stats).LiveSize == Bytes(0) );
+  }
+
+  SECTION("Process-wide heap")
+  {
+    MemSetStats(&Stats);
+    Defer [](){ MemSetStats(nullptr); };
+
+    auto Ptr = MemAllocate(Bytes(100));
+    REQUIRE( AllocStatsSnapshot(Stats).LiveSize == Bytes(128) );
+
+    MemFree(Ptr);
+    REQUIRE( AllocStatsSnapshot(Stats).LiveSize == Bytes(0) );
+  }
+}
+
+TEST_CASE("Allocation stats benchmark", "[.][AllocationStats][Benchmark]")
+{
+  size_t const NumAllocations = 10000000;
+
+  arena Arena;
+  ArenaInit(&Arena, Bytes(NumAllocations * 16));
+  Defer [&](){ ArenaFinalize(&Arena); };
+
+  allocation_stats Stats;
+  AllocStatsInit(&Stats);
+
+  auto Measure = [&]()
+  {
+    ArenaReset(&Arena);
+    auto const Begin = std::chrono::high_resolution_clock::now();
+    for(size_t Index = 0; Index < NumAllocations; ++Index)
+      ArenaAllocateBytes(&Arena, Bytes(16), 16);
+    auto const End = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(End - Begin).count() / NumAllocations;
+  };
+
+  auto const PlainTime = Measure();
+  Arena.Stats = &Stats;
+  auto const StatsTime = Measure();
+
+  std::printf("Allocation stats benchmark (arena allocation, ns/op): without stats %.2f, with stats %.2f\n", PlainTime, StatsTime);
+}
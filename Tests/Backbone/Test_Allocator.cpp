@@ -0,0 +1,227 @@
+#include <Backbone/Allocator.hpp>
+#include <Backbone/Arena.hpp>
+#include <Backbone/StackAllocator.hpp>
+#include <Backbone/Pool.hpp>
+#include <Backbone/Heap.hpp>
+#include <Backbone/BuddyAllocator.hpp>
+#include <Backbone/TlsfAllocator.hpp>
+#include <Backbone/Path.hpp>
+
+#include "catch.hpp"
+
+
+namespace
+{
+  struct counted
+  {
+    static int NumAlive;
+    int Value = 42;
+    counted()  { ++NumAlive; }
+    counted(counted&& Other) : Value(Other.Value) { ++NumAlive; }
+    ~counted() { --NumAlive; }
+  };
+
+  int counted::NumAlive = 0;
+}
+
+/// Runs the same checks against any allocator.
+static void
+TestGenericAllocator(allocator Allocator)
+{
+  auto Ints = AllocatorAllocate<int>(Allocator, 4, 7);
+  REQUIRE( Ints.Num == 4 );
+  REQUIRE( Reinterpret<size_t>(Ints.Ptr) % alignof(int) == 0 );
+  for(auto Int : Ints)
+    REQUIRE( Int == 7 );
+
+  Ints = AllocatorReallocate(Allocator, Ints, 16);
+  REQUIRE( Ints.Num == 16 );
+  for(size_t Index = 0; Index < 4; ++Index)
+    REQUIRE( Ints[Index] == 7 );
+  for(size_t Index = 4; Index < 16; ++Index)
+    REQUIRE( Ints[Index] == 0 );
+
+  Ints = AllocatorReallocate(Allocator, Ints, 2);
+  REQUIRE( Ints.Num == 2 );
+  REQUIRE( Ints[0] == 7 );
+  REQUIRE( Ints[1] == 7 );
+
+  AllocatorFree(Allocator, Ints);
+
+  auto Objects = AllocatorAllocate<counted>(Allocator, 3);
+  REQUIRE( counted::NumAlive == 3 );
+  Objects[1].Value = 1337;
+
+  Objects = AllocatorReallocate(Allocator, Objects, 5);
+  REQUIRE( counted::NumAlive == 5 );
+  REQUIRE( Objects[1].Value == 1337 );
+  REQUIRE( Objects[4].Value == 42 );
+
+  Objects = AllocatorReallocate(Allocator, Objects, 2);
+  REQUIRE( counted::NumAlive == 2 );
+  REQUIRE( Objects[1].Value == 1337 );
+
+  AllocatorFree(Allocator, Objects);
+  REQUIRE( counted::NumAlive == 0 );
+}
+
+TEST_CASE("Allocator interface", "[Allocator]")
+{
+  SECTION("Arena")
+  {
+    arena Arena;
+    ArenaInit(&Arena, KiB(4));
+    Defer [&](){ ArenaFinalize(&Arena); };
+    TestGenericAllocator(AllocatorFrom(&Arena));
+  }
+
+  SECTION("Virtual memory arena")
+  {
+    arena Arena;
+    ArenaInitVirtual(&Arena, MiB(1));
+    Defer [&](){ ArenaFinalize(&Arena); };
+    TestGenericAllocator(AllocatorFrom(&Arena));
+  }
+
+  SECTION("Stack allocator")
+  {
+    stack_allocator Stack;
+    StackInit(&Stack, KiB(4));
+    Defer [&](){ StackFinalize(&Stack); };
+    TestGenericAllocator(AllocatorFrom(&Stack));
+  }
+
+  SECTION("Heap")
+  {
+    heap Heap;
+    HeapInit(&Heap, MiB(4));
+    Defer [&](){ HeapFinalize(&Heap); };
+    TestGenericAllocator(AllocatorFrom(&Heap));
+  }
+
+  SECTION("Buddy allocator")
+  {
+    auto Memory = MemAllocate(KiB(4));
+    Defer [&](){ MemFree(Memory); };
+
+    buddy_allocator Buddy;
+    REQUIRE( BuddyInit(&Buddy, Slice(4096, Memory), Bytes(16)) );
+    Defer [&](){ BuddyFinalize(&Buddy); };
+    TestGenericAllocator(AllocatorFrom(&Buddy));
+    REQUIRE( BuddyUsed(Buddy) == Bytes(0) );
+  }
+
+  SECTION("TLSF allocator")
+  {
+    auto Memory = MemAllocate(KiB(4));
+    Defer [&](){ MemFree(Memory); };
+
+    tlsf_allocator Tlsf;
+    TlsfInit(&Tlsf, Slice(4096, Memory));
+    Defer [&](){ TlsfFinalize(&Tlsf); };
+    TestGenericAllocator(AllocatorFrom(&Tlsf));
+    REQUIRE( TlsfUsed(Tlsf) == Bytes(0) );
+  }
+
+  SECTION("Default allocator")
+  {
+    TestGenericAllocator(DefaultAllocator());
+  }
+}
+
+TEST_CASE("Allocator reallocates in place", "[Allocator]")
+{
+  SECTION("Arena")
+  {
+    arena Arena;
+    ArenaInit(&Arena, KiB(1));
+    Defer [&](){ ArenaFinalize(&Arena); };
+    auto Allocator = AllocatorFrom(&Arena);
+
+    auto Bytes = AllocatorAllocate<uint8>(Allocator, 16);
+    auto Grown = AllocatorReallocate(Allocator, Bytes, 64);
+    REQUIRE( Grown.Ptr == Bytes.Ptr );
+    REQUIRE( ArenaUsed(Arena) == ::Bytes(64) );
+
+    auto Other = AllocatorAllocate<uint8>(Allocator, 1);
+    REQUIRE( Other.Num == 1 );
+
+    // Not the most recent allocation anymore.
+    auto Moved = AllocatorReallocate(Allocator, Grown, 128);
+    REQUIRE( Moved.Num == 128 );
+    REQUIRE( Moved.Ptr != Grown.Ptr );
+  }
+
+  SECTION("Stack allocator")
+  {
+    stack_allocator Stack;
+    StackInit(&Stack, KiB(1));
+    Defer [&](){ StackFinalize(&Stack); };
+    auto Allocator = AllocatorFrom(&Stack);
+
+    auto Bytes = AllocatorAllocate<uint8>(Allocator, 16);
+    auto Grown = AllocatorReallocate(Allocator, Bytes, 64);
+    REQUIRE( Grown.Ptr == Bytes.Ptr );
+    REQUIRE( StackUsed(Stack) == ::Bytes(64) );
+
+    auto TooBig = AllocatorReallocate(Allocator, Grown, 2048);
+    REQUIRE( TooBig.Num == 0 );
+    REQUIRE( StackUsed(Stack) == ::Bytes(64) );
+  }
+}
+
+TEST_CASE("Pool allocator", "[Allocator]")
+{
+  pool<uint64> Pool;
+  PoolInit(&Pool);
+  Defer [&](){ PoolFinalize(&Pool); };
+  auto Allocator = AllocatorFrom(&Pool);
+
+  auto A = AllocatorAllocate<uint32>(Allocator, 2);
+  REQUIRE( A.Num == 2 );
+  REQUIRE( Pool.NumLive == 1 );
+
+  // Does not fit into a single slot.
+  auto B = AllocatorAllocate<uint32>(Allocator, 3);
+  REQUIRE( B.Num == 0 );
+  REQUIRE( Pool.NumLive == 1 );
+
+  AllocatorFree(Allocator, A);
+  REQUIRE( Pool.NumLive == 0 );
+}
+
+TEST_CASE("Concat paths with an allocator", "[Allocator][Path]")
+{
+  stack_allocator Stack;
+  StackInit(&Stack, KiB(1));
+  Defer [&](){ StackFinalize(&Stack); };
+
+  path_options Options;
+  Options.Separator = '/';
+  Options.AppendNull = true;
+
+  auto Path = ConcatPaths("Foo"_S, "Bar.txt"_S, AllocatorFrom(&Stack), Options);
+  REQUIRE( Path == "Foo/Bar.txt"_S );
+  REQUIRE( Path.Ptr[Path.Num] == '\0' );
+  REQUIRE( StackUsed(Stack) == Bytes(Path.Num + 1) );
+}
+
+TEST_CASE("Aligned allocation", "[Allocator]")
+{
+  arena Arena;
+  ArenaInit(&Arena, KiB(4));
+  Defer [&](){ ArenaFinalize(&Arena); };
+
+  for(size_t Alignment = 1; Alignment <= 256; Alignment *= 2)
+  {
+    CAPTURE( Alignment );
+    AllocatorAllocate<uint8>(AllocatorFrom(&Arena), 1);
+    auto Floats = AllocatorAllocateAligned<float>(AllocatorFrom(&Arena), 8, Alignment);
+    REQUIRE( Floats.Num == 8 );
+    REQUIRE( IsAligned(Floats.Ptr, Max(Alignment, alignof(float))) );
+  }
+
+  auto Big = AllocatorAllocateAligned<uint8>(DefaultAllocator(), 100, 4096);
+  REQUIRE( IsAligned(Big.Ptr, 4096) );
+  AllocatorFree(DefaultAllocator(), Big);
+}
@@ -0,0 +1,167 @@
+#include <Backbone/Arena.hpp>
+#include <Backbone/FixedBlock.hpp>
+
+#include "catch.hpp"
+
+
+TEST_CASE("Arena from buffer", "[Arena]")
+{
+  fixed_block<64, uint8> Buffer;
+  arena Arena;
+  ArenaInit(&Arena, SliceReinterpret<void>(Slice(Buffer)));
+  Defer [&](){ ArenaFinalize(&Arena); };
+
+  REQUIRE( ArenaCapacity(Arena) == Bytes(64) );
+  REQUIRE( ArenaUsed(Arena) == Bytes(0) );
+
+  SECTION("Allocate and construct")
+  {
+    auto Ints = ArenaAllocate<int>(&Arena, 4, 42);
+    REQUIRE( Ints.Num == 4 );
+    REQUIRE( Reinterpret<size_t>(Ints.Ptr) % alignof(int) == 0 );
+    REQUIRE( Ints[0] == 42 );
+    REQUIRE( Ints[3] == 42 );
+    REQUIRE( ArenaUsed(Arena) >= 4 * SizeOf<int>() );
+
+    auto Zeroes = ArenaAllocate<uint64>(&Arena, 2);
+    REQUIRE( Zeroes.Num == 2 );
+    REQUIRE( Reinterpret<size_t>(Zeroes.Ptr) % alignof(uint64) == 0 );
+    REQUIRE( Zeroes[0] == 0 );
+    REQUIRE( Zeroes[1] == 0 );
+    REQUIRE( Reinterpret<size_t>(First(Zeroes)) >= Reinterpret<size_t>(OnePastLast(Ints)) );
+  }
+
+  SECTION("Running out of memory")
+  {
+    auto Bytes64 = ArenaAllocate<uint8>(&Arena, 64);
+    REQUIRE( Bytes64.Num == 64 );
+
+    auto Nothing = ArenaAllocate<uint8>(&Arena, 1);
+    REQUIRE( Nothing.Num == 0 );
+    REQUIRE( Nothing.Ptr == nullptr );
+    REQUIRE( ArenaUsed(Arena) == Bytes(64) );
+  }
+
+  SECTION("Sizes that wrap around")
+  {
+    ArenaAllocate<uint8>(&Arena, 3);
+    REQUIRE( ArenaAllocateBytes(&Arena, Bytes(IntMaxValue<size_t>() - 1), 1) == nullptr );
+    REQUIRE( ArenaAllocate<uint64>(&Arena, IntMaxValue<size_t>() / 4).Ptr == nullptr );
+    REQUIRE( ArenaAllocateBytes(&Arena, Bytes(1), size_t(1) << 40) == nullptr );
+
+    auto Allocator = AllocatorFrom(&Arena);
+    auto Ptr = AllocatorAllocateBytes(Allocator, Bytes(8), 1);
+    REQUIRE( Ptr != nullptr );
+    REQUIRE( AllocatorReallocateBytes(Allocator, Ptr, Bytes(8), Bytes(IntMaxValue<size_t>() - 4), 1) == nullptr );
+    REQUIRE( ArenaUsed(Arena) == Bytes(11) );
+  }
+
+  SECTION("Reset")
+  {
+    auto First = ArenaAllocate<uint8>(&Arena, 32);
+    ArenaReset(&Arena);
+    REQUIRE( ArenaUsed(Arena) == Bytes(0) );
+
+    auto Second = ArenaAllocate<uint8>(&Arena, 32);
+    REQUIRE( Second.Ptr == First.Ptr );
+  }
+}
+
+TEST_CASE("Arena with own memory", "[Arena]")
+{
+  arena Arena;
+  ArenaInit(&Arena, KiB(1));
+  REQUIRE( Arena.Backing == arena::HeapMemory );
+  REQUIRE( ArenaCapacity(Arena) == KiB(1) );
+
+  auto Floats = ArenaAllocate<float>(&Arena, 256, 1.5f);
+  REQUIRE( Floats.Num == 256 );
+  REQUIRE( Floats[255] == 1.5f );
+
+  ArenaFinalize(&Arena);
+  REQUIRE( Arena.Memory.Ptr == nullptr );
+  REQUIRE( ArenaCapacity(Arena) == Bytes(0) );
+}
+
+TEST_CASE("Virtual memory arena", "[Arena]")
+{
+  arena Arena;
+  ArenaInitVirtual(&Arena, GiB(64));
+  Defer [&](){ ArenaFinalize(&Arena); };
+
+  REQUIRE( Arena.Backing == arena::VirtualMemory );
+  REQUIRE( ArenaCapacity(Arena) == GiB(64) );
+  REQUIRE( ArenaCommitted(Arena) == Bytes(0) );
+
+  auto First = ArenaAllocate<uint8>(&Arena, 100, uint8(1));
+  REQUIRE( First.Num == 100 );
+  REQUIRE( ArenaCommitted(Arena) >= Bytes(100) );
+  REQUIRE( ArenaCommitted(Arena) < ArenaCapacity(Arena) );
+
+  SECTION("Growing keeps pointers stable")
+  {
+    auto Big = ArenaAllocate<uint8>(&Arena, ToBytes(MiB(3)), uint8(2));
+    REQUIRE( Big.Num == ToBytes(MiB(3)) );
+    REQUIRE( ArenaCommitted(Arena) >= MiB(3) );
+    REQUIRE( First[99] == 1 );
+    REQUIRE( Big[0] == 2 );
+    REQUIRE( Big[Big.Num - 1] == 2 );
+  }
+
+  SECTION("Decommit")
+  {
+    ArenaAllocate<uint8>(&Arena, ToBytes(MiB(1)));
+    ArenaReset(&Arena);
+    ArenaDecommitUnused(&Arena);
+    REQUIRE( ArenaCommitted(Arena) == Bytes(0) );
+
+    // Recommitted memory must be usable again.
+    auto Again = ArenaAllocate<uint64>(&Arena, 1000, 42ULL);
+    REQUIRE( Again[999] == 42 );
+  }
+}
+
+TEST_CASE("Huge page arena", "[Arena]")
+{
+  // Whether huge pages are available depends on the system. Whatever mode
+  // the arena ends up with must work and be reported.
+  auto Check = [](virtual_mem_page_mode Requested)
+  {
+    CAPTURE( Requested );
+    allocation_stats Stats;
+    AllocStatsInit(&Stats);
+
+    arena Arena;
+    ArenaInitVirtual(&Arena, MiB(64), Requested);
+    Arena.Stats = &Stats;
+    Defer [&](){ ArenaFinalize(&Arena); };
+
+    CAPTURE( Arena.PageMode );
+    REQUIRE( Arena.Memory.Ptr != nullptr );
+    REQUIRE( Arena.PageMode <= Requested );
+    if(Arena.PageMode != VirtualMem_NormalPages)
+    {
+      REQUIRE( IsAligned(Arena.Memory.Ptr, ToBytes(VirtualMemHugePageSize())) );
+    }
+
+    auto Data = ArenaAllocate<uint8>(&Arena, ToBytes(MiB(5)), uint8(3));
+    REQUIRE( Data.Num == ToBytes(MiB(5)) );
+    REQUIRE( Data[Data.Num - 1] == 3 );
+
+    auto Snapshot = AllocStatsSnapshot(Stats);
+    REQUIRE( Snapshot.CommittedSize[Arena.PageMode] == ArenaCommitted(Arena) );
+    for(size_t PageMode = 0; PageMode < VirtualMem_NumPageModes; ++PageMode)
+    {
+      if(PageMode != Arena.PageMode)
+        REQUIRE( Snapshot.CommittedSize[PageMode] == Bytes(0) );
+    }
+
+    ArenaReset(&Arena);
+    ArenaDecommitUnused(&Arena);
+    REQUIRE( AllocStatsSnapshot(Stats).CommittedSize[Arena.PageMode] == ArenaCommitted(Arena) );
+  };
+
+  Check(VirtualMem_NormalPages);
+  Check(VirtualMem_TransparentHugePages);
+  Check(VirtualMem_ExplicitHugePages);
+}
@@ -0,0 +1,234 @@
+#include <Backbone/BuddyAllocator.hpp>
+#include <Backbone/Heap.hpp>
+
+#include "catch.hpp"
+
+#include <random>
+#include <vector>
+
+
+TEST_CASE("Buddy allocator basics", "[BuddyAllocator]")
+{
+  auto Memory = MemAllocate(KiB(1), 1024);
+  Defer [&](){ MemFree(Memory); };
+
+  buddy_allocator Buddy;
+  REQUIRE( BuddyInit(&Buddy, Slice(1024, Memory), Bytes(64)) );
+  Defer [&](){ BuddyFinalize(&Buddy); };
+
+  REQUIRE( BuddyCapacity(Buddy) == KiB(1) );
+  REQUIRE( BuddyUsed(Buddy) == Bytes(0) );
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == KiB(1) );
+  REQUIRE( BuddyFragmentation(Buddy) == Bytes(0) );
+
+  // Sizes are rounded up to the next power of two.
+  auto A = BuddyAllocateBytes(&Buddy, Bytes(100), 1);
+  REQUIRE( A == Memory );
+  REQUIRE( BuddyBlockSize(Buddy, A) == Bytes(128) );
+  REQUIRE( BuddyUsed(Buddy) == Bytes(128) );
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == Bytes(512) );
+  REQUIRE( BuddyFragmentation(Buddy) == Bytes(384) );
+
+  auto B = BuddyAllocateBytes(&Buddy, Bytes(1), 1);
+  REQUIRE( BuddyBlockSize(Buddy, B) == Bytes(64) );
+  REQUIRE( B == MemAddByteOffset(Memory, 128) );
+
+  // Blocks are aligned to their size.
+  auto C = BuddyAllocateBytes(&Buddy, Bytes(64), 256);
+  REQUIRE( BuddyBlockSize(Buddy, C) == Bytes(256) );
+  REQUIRE( C == MemAddByteOffset(Memory, 256) );
+
+  auto D = BuddyAllocateBytes(&Buddy, Bytes(512), 1);
+  REQUIRE( D == MemAddByteOffset(Memory, 512) );
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == Bytes(64) );
+
+  // Too big for anything that is left.
+  REQUIRE( BuddyAllocateBytes(&Buddy, Bytes(65), 1) == nullptr );
+
+  // Freeing merges buddies back into bigger blocks.
+  BuddyFree(&Buddy, A);
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == Bytes(128) );
+  BuddyFree(&Buddy, B);
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == Bytes(256) );
+  BuddyFree(&Buddy, C);
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == Bytes(512) );
+  BuddyFree(&Buddy, D);
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == KiB(1) );
+  REQUIRE( BuddyUsed(Buddy) == Bytes(0) );
+  REQUIRE( BuddyFragmentation(Buddy) == Bytes(0) );
+
+  BuddyFree(&Buddy, nullptr);
+}
+
+TEST_CASE("Buddy allocator fragmentation", "[BuddyAllocator]")
+{
+  auto Memory = MemAllocate(KiB(1), 1024);
+  Defer [&](){ MemFree(Memory); };
+
+  buddy_allocator Buddy;
+  REQUIRE( BuddyInit(&Buddy, Slice(1024, Memory), Bytes(64)) );
+  Defer [&](){ BuddyFinalize(&Buddy); };
+
+  void* Blocks[16];
+  for(auto& Block : Blocks)
+    Block = BuddyAllocateBytes(&Buddy, Bytes(64), 1);
+  REQUIRE( BuddyAllocateBytes(&Buddy, Bytes(1), 1) == nullptr );
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == Bytes(0) );
+
+  // Free every other block, nothing can merge.
+  for(size_t Index = 0; Index < 16; Index += 2)
+    BuddyFree(&Buddy, Blocks[Index]);
+  REQUIRE( BuddyUsed(Buddy) == Bytes(512) );
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == Bytes(64) );
+  REQUIRE( BuddyFragmentation(Buddy) == Bytes(448) );
+  REQUIRE( BuddyAllocateBytes(&Buddy, Bytes(128), 1) == nullptr );
+
+  // Free blocks are reused before anything else.
+  auto Reused = BuddyAllocateBytes(&Buddy, Bytes(64), 1);
+  REQUIRE( Reused == Blocks[0] );
+  Blocks[0] = Reused;
+
+  for(size_t Index = 1; Index < 16; Index += 2)
+    BuddyFree(&Buddy, Blocks[Index]);
+  BuddyFree(&Buddy, Blocks[0]);
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == KiB(1) );
+}
+
+TEST_CASE("Buddy allocator ignores foreign pointers", "[BuddyAllocator]")
+{
+  auto Memory = MemAllocate(KiB(1), 1024);
+  Defer [&](){ MemFree(Memory); };
+
+  buddy_allocator Buddy;
+  REQUIRE( BuddyInit(&Buddy, Slice(1024, Memory), Bytes(64)) );
+  Defer [&](){ BuddyFinalize(&Buddy); };
+
+  auto Block = BuddyAllocateBytes(&Buddy, Bytes(128), 1);
+  REQUIRE( Block == Memory );
+  REQUIRE( BuddyUsed(Buddy) == Bytes(128) );
+
+  // Never handed out: a free block, the middle of an allocated block, an
+  // unaligned address, and something outside of the memory.
+  int Outside;
+  void* const Foreign[] = { MemAddByteOffset(Memory, 512), MemAddByteOffset(Memory, 64),
+                            MemAddByteOffset(Memory, 200), &Outside };
+  for(auto Ptr : Foreign)
+  {
+    REQUIRE( BuddyBlockSize(Buddy, Ptr) == Bytes(0) );
+    BuddyFree(&Buddy, Ptr);
+    REQUIRE( BuddyUsed(Buddy) == Bytes(128) );
+  }
+
+  // Double free.
+  BuddyFree(&Buddy, Block);
+  BuddyFree(&Buddy, Block);
+  REQUIRE( BuddyUsed(Buddy) == Bytes(0) );
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == KiB(1) );
+
+  // Element counts whose size doesn't fit into a size_t.
+  REQUIRE( BuddyAllocate<uint64>(&Buddy, IntMaxValue<size_t>() / 4).Ptr == nullptr );
+  REQUIRE( BuddyUsed(Buddy) == Bytes(0) );
+}
+
+TEST_CASE("Buddy allocator with uneven memory", "[BuddyAllocator]")
+{
+  auto Memory = MemAllocate(KiB(1), 64);
+  Defer [&](){ MemFree(Memory); };
+
+  // Skip the first few bytes, so the allocator has to align the beginning
+  // and can't use a power of two of blocks.
+  buddy_allocator Buddy;
+  REQUIRE( BuddyInit(&Buddy, Slice(1024 - 8, MemAddByteOffset(Memory, 8)), Bytes(64)) );
+  Defer [&](){ BuddyFinalize(&Buddy); };
+
+  REQUIRE( Buddy.Memory.Ptr == MemAddByteOffset(Memory, 64) );
+  REQUIRE( BuddyCapacity(Buddy) == Bytes(15 * 64) );
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == Bytes(512) );
+  REQUIRE( BuddyFragmentation(Buddy) == Bytes(7 * 64) );
+
+  std::vector<void*> Blocks;
+  while(auto Block = BuddyAllocateBytes(&Buddy, Bytes(64), 1))
+    Blocks.push_back(Block);
+  REQUIRE( Blocks.size() == 15 );
+  REQUIRE( BuddyUsed(Buddy) == BuddyCapacity(Buddy) );
+
+  for(auto Block : Blocks)
+    BuddyFree(&Buddy, Block);
+  REQUIRE( BuddyUsed(Buddy) == Bytes(0) );
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == Bytes(512) );
+
+  // Not even a single block fits.
+  buddy_allocator Tiny;
+  REQUIRE( !BuddyInit(&Tiny, Slice(32, Memory), Bytes(64)) );
+  REQUIRE( BuddyCapacity(Tiny) == Bytes(0) );
+  REQUIRE( BuddyAllocateBytes(&Tiny, Bytes(1), 1) == nullptr );
+  BuddyFinalize(&Tiny);
+
+  // The tree for a region this large with single byte blocks can't be
+  // allocated. The region itself is never touched.
+  buddy_allocator Huge;
+  REQUIRE( !BuddyInit(&Huge, Slice(size_t(1) << 50, Memory), Bytes(1)) );
+  REQUIRE( BuddyCapacity(Huge) == Bytes(0) );
+  REQUIRE( BuddyAllocateBytes(&Huge, Bytes(1), 1) == nullptr );
+  BuddyFinalize(&Huge);
+}
+
+TEST_CASE("Buddy allocator random allocations", "[BuddyAllocator]")
+{
+  auto Memory = MemAllocate(MiB(1), 4096);
+  Defer [&](){ MemFree(Memory); };
+
+  buddy_allocator Buddy;
+  REQUIRE( BuddyInit(&Buddy, Slice(Convert<size_t>(ToBytes(MiB(1))), Memory), Bytes(32)) );
+  Defer [&](){ BuddyFinalize(&Buddy); };
+
+  allocation_stats Stats;
+  AllocStatsInit(&Stats);
+  Buddy.Stats = &Stats;
+
+  struct allocation
+  {
+    uint8* Ptr;
+    size_t Size;
+    uint8 Pattern;
+  };
+
+  std::mt19937 Random(1337);
+  std::vector<allocation> Live;
+  for(int Iteration = 0; Iteration < 20000; ++Iteration)
+  {
+    if(Live.empty() || Random() % 3 != 0)
+    {
+      auto const Size = size_t(1) + Random() % 4096;
+      auto Ptr = Reinterpret<uint8*>(BuddyAllocateBytes(&Buddy, Bytes(Size), 16));
+      if(Ptr == nullptr)
+        continue;
+
+      REQUIRE( BuddyBlockSize(Buddy, Ptr) >= Bytes(Size) );
+      auto const Pattern = uint8(Iteration);
+      MemSet(Size, Ptr, Pattern);
+      Live.push_back({ Ptr, Size, Pattern });
+    }
+    else
+    {
+      auto const Index = Random() % Live.size();
+      auto const Victim = Live[Index];
+      Live[Index] = Live.back();
+      Live.pop_back();
+
+      // Nobody else wrote to this block.
+      size_t NumOverwritten = 0;
+      for(size_t Offset = 0; Offset < Victim.Size; ++Offset)
+        NumOverwritten += Victim.Ptr[Offset] != Victim.Pattern;
+      REQUIRE( NumOverwritten == 0 );
+      BuddyFree(&Buddy, Victim.Ptr);
+    }
+  }
+
+  for(auto& Allocation : Live)
+    BuddyFree(&Buddy, Allocation.Ptr);
+
+  REQUIRE( BuddyUsed(Buddy) == Bytes(0) );
+  REQUIRE( BuddyLargestFreeBlock(Buddy) == MiB(1) );
+  REQUIRE( AllocStatsSnapshot(Stats).LiveSize == Bytes(0) );
+}
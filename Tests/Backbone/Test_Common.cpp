@@ -188,6 +188,102 @@ TEST_CASE("IsPowerOfTwo", "[Common]")
   NegativeTest( 1024-1 );
 }
 
+TEST_CASE("Bit scan", "[Common]")
+{
+  for(uint64 Index = 0; Index < 64; ++Index)
+  {
+    CAPTURE( Index );
+    REQUIRE( FindFirstSetBit(uint64(1) << Index) == Index );
+    REQUIRE( FindLastSetBit(uint64(1) << Index) == Index );
+  }
+
+  REQUIRE( FindFirstSetBit(0b10110000) == 4 );
+  REQUIRE( FindLastSetBit(0b10110000) == 7 );
+  REQUIRE( FindFirstSetBit(~uint64(0)) == 0 );
+  REQUIRE( FindLastSetBit(~uint64(0)) == 63 );
+}
+
+TEST_CASE("Byte swap", "[Common]")
+{
+  REQUIRE( ByteSwap(uint16(0x1234)) == 0x3412 );
+  REQUIRE( ByteSwap(uint32(0x12345678)) == 0x78563412 );
+  REQUIRE( ByteSwap(uint64(0x0123456789ABCDEF)) == 0xEFCDAB8967452301 );
+  REQUIRE( ByteSwap(int16(-2)) == int16(0xFEFF) );
+  REQUIRE( ByteSwap(int32(1)) == 0x01000000 );
+  REQUIRE( ByteSwap(ByteSwap(int64(-1234567))) == -1234567 );
+}
+
+TEST_CASE("CPU features", "[Common]")
+{
+  auto const Detected = CpuFeatures();
+  Defer [=](){ CpuRestrictFeatures(~uint32(0)); };
+
+#if defined(BB_Platform_x64)
+  REQUIRE( CpuHasFeature(Cpu_SSE2) );
+#endif
+
+  // AVX2 implies AVX.
+  if(CpuHasFeature(Cpu_AVX2))
+    REQUIRE( CpuHasFeature(Cpu_AVX) );
+
+  CpuRestrictFeatures(Cpu_SSE2);
+  REQUIRE( CpuFeatures() == (Detected & Cpu_SSE2) );
+  REQUIRE( !CpuHasFeature(Cpu_AVX) );
+
+  CpuRestrictFeatures(~uint32(0));
+  REQUIRE( CpuFeatures() == Detected );
+}
+
+TEST_CASE("Alignment", "[Common]")
+{
+  SECTION("Sizes")
+  {
+    REQUIRE( AlignUp(size_t(0), 16) == 0 );
+    REQUIRE( AlignUp(size_t(1), 16) == 16 );
+    REQUIRE( AlignUp(size_t(16), 16) == 16 );
+    REQUIRE( AlignUp(size_t(17), 16) == 32 );
+    REQUIRE( AlignDown(size_t(17), 16) == 16 );
+    REQUIRE( AlignDown(size_t(15), 16) == 0 );
+    REQUIRE( IsAligned(size_t(64), 32) );
+    REQUIRE( !IsAligned(size_t(48), 32) );
+    REQUIRE( IsAligned(size_t(7), 1) );
+  }
+
+  SECTION("Memory sizes")
+  {
+    REQUIRE( AlignUp(Bytes(100), 64) == Bytes(128) );
+    REQUIRE( AlignDown(Bytes(100), 64) == Bytes(64) );
+    REQUIRE( IsAligned(KiB(4), 4096) );
+    REQUIRE( !IsAligned(Bytes(4097), 4096) );
+  }
+
+  SECTION("Pointers")
+  {
+    alignas(64) uint8 Buffer[128];
+    REQUIRE( IsAligned(&Buffer[0], 64) );
+    REQUIRE( !IsAligned(&Buffer[1], 2) );
+    REQUIRE( AlignUp(&Buffer[1], 32) == &Buffer[32] );
+    REQUIRE( AlignUp(&Buffer[32], 32) == &Buffer[32] );
+    REQUIRE( AlignDown(&Buffer[63], 32) == &Buffer[32] );
+
+    void const* Ptr = &Buffer[3];
+    REQUIRE( AlignUp(Ptr, 4) == &Buffer[4] );
+  }
+
+  SECTION("Cache line padding")
+  {
+    static_assert(sizeof(cache_line_padded<uint8>) == CacheLineSize, "");
+    static_assert(alignof(cache_line_padded<uint8>) == CacheLineSize, "");
+    static_assert(sizeof(cache_line_padded<uint8[65]>) == 2 * CacheLineSize, "");
+
+    cache_line_padded<int> Counters[2];
+    Counters[0].Value = 1;
+    Counters[1].Value = 2;
+    REQUIRE( IsAligned(&Counters[1].Value, CacheLineSize) );
+    REQUIRE( Reinterpret<size_t>(&Counters[1].Value) - Reinterpret<size_t>(&Counters[0].Value) == CacheLineSize );
+  }
+}
+
 TEST_CASE("Min", "[Common]")
 {
   REQUIRE(Min( 0,  1) == 0);
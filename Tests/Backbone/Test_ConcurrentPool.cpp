@@ -0,0 +1,228 @@
+#include <Backbone/ConcurrentPool.hpp>
+#include <Backbone/Pool.hpp>
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+  struct message
+  {
+    uint64 Sender;
+    uint64 Sequence;
+    uint8 Payload[48];
+  };
+
+  /// A fixed-capacity single-producer single-consumer queue of pointers used
+  /// to hand objects from one thread to another.
+  template<size_t N>
+  struct handoff_queue
+  {
+    message* Items[N];
+    cache_line_padded<std::atomic<size_t>> Head;
+    cache_line_padded<std::atomic<size_t>> Tail;
+
+    handoff_queue() { Head.Value = 0; Tail.Value = 0; }
+
+    bool Push(message* Item)
+    {
+      auto const Tail_ = Tail.Value.load(std::memory_order_relaxed);
+      if(Tail_ - Head.Value.load(std::memory_order_acquire) == N)
+        return false;
+      Items[Tail_ % N] = Item;
+      Tail.Value.store(Tail_ + 1, std::memory_order_release);
+      return true;
+    }
+
+    message* Pop()
+    {
+      auto const Head_ = Head.Value.load(std::memory_order_relaxed);
+      if(Head_ == Tail.Value.load(std::memory_order_acquire))
+        return nullptr;
+      auto Item = Items[Head_ % N];
+      Head.Value.store(Head_ + 1, std::memory_order_release);
+      return Item;
+    }
+  };
+}
+
+TEST_CASE("Concurrent pool basics", "[ConcurrentPool]")
+{
+  concurrent_pool<int> Ints;
+  REQUIRE( ConcurrentPoolInit(&Ints, 4) );
+  Defer [&](){ ConcurrentPoolFinalize(&Ints); };
+
+  auto A = ConcurrentPoolCreate(&Ints, 1);
+  auto B = ConcurrentPoolCreate(&Ints, 2);
+  auto C = ConcurrentPoolCreate(&Ints, 3);
+  auto D = ConcurrentPoolCreate(&Ints, 4);
+  REQUIRE( A != nullptr );
+  REQUIRE( D != nullptr );
+  REQUIRE( *A == 1 );
+  REQUIRE( *D == 4 );
+
+  // Out of slots.
+  REQUIRE( ConcurrentPoolCreate(&Ints) == nullptr );
+
+  ConcurrentPoolDestroy(&Ints, B);
+  ConcurrentPoolDestroy(&Ints, C);
+
+  // Freed slots are reused in LIFO order.
+  auto E = ConcurrentPoolCreate(&Ints, 5);
+  auto F = ConcurrentPoolCreate(&Ints, 6);
+  REQUIRE( E == C );
+  REQUIRE( F == B );
+  REQUIRE( ConcurrentPoolCreate(&Ints) == nullptr );
+  REQUIRE( *A == 1 );
+  REQUIRE( *E == 5 );
+  REQUIRE( *F == 6 );
+}
+
+TEST_CASE("Concurrent pool of over-aligned types", "[ConcurrentPool]")
+{
+  concurrent_pool<cache_line_padded<uint32>> Counters;
+  REQUIRE( ConcurrentPoolInit(&Counters, 100) );
+  Defer [&](){ ConcurrentPoolFinalize(&Counters); };
+
+  for(int Index = 0; Index < 100; ++Index)
+    REQUIRE( IsAligned(ConcurrentPoolCreate(&Counters), CacheLineSize) );
+}
+
+TEST_CASE("Concurrent pool cross-thread create and destroy", "[ConcurrentPool]")
+{
+  size_t const NumPairs = 4;
+  size_t const NumMessagesPerPair = 20000;
+
+  concurrent_pool<message> Messages;
+  REQUIRE( ConcurrentPoolInit(&Messages, 1024) );
+  Defer [&](){ ConcurrentPoolFinalize(&Messages); };
+
+  allocation_stats Stats;
+  AllocStatsInit(&Stats);
+  Messages.Stats = &Stats;
+
+  std::vector<handoff_queue<64>> Queues(NumPairs);
+  std::atomic<size_t> NumErrors{ 0 };
+  std::vector<std::thread> Threads;
+  for(size_t PairIndex = 0; PairIndex < NumPairs; ++PairIndex)
+  {
+    auto Queue = &Queues[PairIndex];
+    Threads.emplace_back([&, Queue, PairIndex]()
+    {
+      for(size_t Sequence = 0; Sequence < NumMessagesPerPair; ++Sequence)
+      {
+        message* Message;
+        while((Message = ConcurrentPoolCreate(&Messages)) == nullptr)
+          std::this_thread::yield();
+        Message->Sender = PairIndex;
+        Message->Sequence = Sequence;
+        while(!Queue->Push(Message))
+          std::this_thread::yield();
+      }
+    });
+    Threads.emplace_back([&, Queue, PairIndex]()
+    {
+      for(size_t Sequence = 0; Sequence < NumMessagesPerPair; ++Sequence)
+      {
+        message* Message;
+        while((Message = Queue->Pop()) == nullptr)
+          std::this_thread::yield();
+        if(Message->Sender != PairIndex || Message->Sequence != Sequence)
+          ++NumErrors;
+        ConcurrentPoolDestroy(&Messages, Message);
+      }
+    });
+  }
+  for(auto& Thread : Threads) Thread.join();
+
+  REQUIRE( NumErrors == 0 );
+
+  auto Snapshot = AllocStatsSnapshot(Stats);
+  REQUIRE( Snapshot.NumAllocations == NumPairs * NumMessagesPerPair );
+  REQUIRE( Snapshot.NumFrees == NumPairs * NumMessagesPerPair );
+  REQUIRE( Snapshot.LiveSize == Bytes(0) );
+
+  // All slots must be back on the free list exactly once.
+  std::vector<message*> All;
+  while(auto Message = ConcurrentPoolCreate(&Messages))
+    All.push_back(Message);
+  REQUIRE( All.size() == 1024 );
+  std::sort(All.begin(), All.end());
+  REQUIRE( std::unique(All.begin(), All.end()) == All.end() );
+}
+
+TEST_CASE("Concurrent pool benchmark", "[.][ConcurrentPool][Benchmark]")
+{
+  size_t const NumMessagesPerPair = 1000000;
+
+  /// The alternative: a regular pool behind a lock.
+  struct mutex_pool
+  {
+    pool<message> Pool;
+    std::mutex Mutex;
+  };
+
+  auto Measure = [&](size_t NumPairs, auto Create, auto Destroy)
+  {
+    std::vector<handoff_queue<256>> Queues(NumPairs);
+    std::vector<std::thread> Threads;
+    auto const Begin = std::chrono::high_resolution_clock::now();
+    for(size_t PairIndex = 0; PairIndex < NumPairs; ++PairIndex)
+    {
+      auto Queue = &Queues[PairIndex];
+      Threads.emplace_back([&, Queue]()
+      {
+        for(size_t Sequence = 0; Sequence < NumMessagesPerPair; ++Sequence)
+        {
+          message* Message;
+          while((Message = Create()) == nullptr)
+            std::this_thread::yield();
+          Message->Sequence = Sequence;
+          while(!Queue->Push(Message))
+            std::this_thread::yield();
+        }
+      });
+      Threads.emplace_back([&, Queue]()
+      {
+        for(size_t Sequence = 0; Sequence < NumMessagesPerPair; ++Sequence)
+        {
+          message* Message;
+          while((Message = Queue->Pop()) == nullptr)
+            std::this_thread::yield();
+          Destroy(Message);
+        }
+      });
+    }
+    for(auto& Thread : Threads) Thread.join();
+    auto const End = std::chrono::high_resolution_clock::now();
+    auto const Seconds = std::chrono::duration<double>(End - Begin).count();
+    return double(NumPairs * NumMessagesPerPair) / Seconds / 1e6;
+  };
+
+  std::printf("Concurrent pool benchmark (create on producer, destroy on consumer, million messages/s)\n");
+  for(size_t NumPairs = 1; NumPairs <= 8; NumPairs *= 2)
+  {
+    mutex_pool Locked;
+    PoolInit(&Locked.Pool);
+    Defer [&](){ PoolFinalize(&Locked.Pool); };
+    auto const MutexRate = Measure(NumPairs,
+      [&](){ std::lock_guard<std::mutex> Lock(Locked.Mutex); return PoolCreate(&Locked.Pool); },
+      [&](message* Message){ std::lock_guard<std::mutex> Lock(Locked.Mutex); PoolDestroy(&Locked.Pool, Message); });
+
+    concurrent_pool<message> LockFree;
+    ConcurrentPoolInit(&LockFree, uint32(NumPairs * 512));
+    Defer [&](){ ConcurrentPoolFinalize(&LockFree); };
+    auto const LockFreeRate = Measure(NumPairs,
+      [&](){ return ConcurrentPoolCreate(&LockFree); },
+      [&](message* Message){ ConcurrentPoolDestroy(&LockFree, Message); });
+
+    std::printf("  %zu pairs: mutex pool %.1f, concurrent pool %.1f\n", NumPairs, MutexRate, LockFreeRate);
+  }
+}
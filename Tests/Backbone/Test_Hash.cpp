@@ -0,0 +1,278 @@
+#include <Backbone/Hash.hpp>
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+static_assert(SliceHashConstexpr("Position"_S) != SliceHashConstexpr("Normal"_S), "");
+static_assert(SliceHashConstexpr("Position"_S) != SliceHashConstexpr("Position"_S, 1), "");
+
+TEST_CASE("Hash of string literals at compile time", "[Hash]")
+{
+  constexpr uint64 Empty = SliceHashConstexpr(""_S);
+  constexpr uint64 Short = SliceHashConstexpr("Position"_S);
+  constexpr uint64 Long = SliceHashConstexpr("The quick brown fox jumps over the lazy dog, twice over."_S);
+  REQUIRE( SliceHash(""_S) == Empty );
+  REQUIRE( SliceHash("Position"_S) == Short );
+  REQUIRE( SliceHash("The quick brown fox jumps over the lazy dog, twice over."_S) == Long );
+
+  auto Classify = [](slice<char const> Name)
+  {
+    switch(SliceHash(Name))
+    {
+      case SliceHashConstexpr("Position"_S): return 1;
+      case SliceHashConstexpr("Normal"_S):   return 2;
+      default:                               return 0;
+    }
+  };
+  REQUIRE( Classify("Position"_S) == 1 );
+  REQUIRE( Classify("Normal"_S) == 2 );
+  REQUIRE( Classify("Color"_S) == 0 );
+
+  // The runtime and compile time implementations must agree for every
+  // length, across all code paths.
+  char Text[256];
+  for(size_t Index = 0; Index < sizeof(Text); ++Index)
+    Text[Index] = char(Index * 7 + 200);
+
+  size_t NumMismatches = 0;
+  for(size_t Size = 0; Size <= sizeof(Text); ++Size)
+  {
+    for(uint64 Seed : { uint64(0), uint64(1), uint64(0xDEADBEEFCAFE) })
+    {
+      auto const String = Slice(Size, AsPtrToConst(&Text[0]));
+      if(SliceHash(String, Seed) != SliceHashConstexpr(String, Seed))
+        ++NumMismatches;
+    }
+  }
+  REQUIRE( NumMismatches == 0 );
+}
+
+TEST_CASE("Hash slices", "[Hash]")
+{
+  int Numbers[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+  auto const Hash = SliceHash(Slice(Numbers));
+  REQUIRE( Hash == MemHashBytes(Bytes(sizeof(Numbers)), Numbers) );
+  REQUIRE( Hash == SliceHash(AsConst(Slice(Numbers))) );
+  REQUIRE( Hash != SliceHash(Slice(Numbers), 42) );
+  REQUIRE( Hash != SliceHash(SliceTrimBack(Slice(Numbers), 1)) );
+
+  Numbers[9] = 11;
+  REQUIRE( Hash != SliceHash(Slice(Numbers)) );
+}
+
+TEST_CASE("Hash streaming", "[Hash]")
+{
+  uint8 Data[400];
+  for(size_t Index = 0; Index < sizeof(Data); ++Index)
+    Data[Index] = uint8(Index * 31 + 17);
+
+  // Every size, split into chunks of various sizes around the block size.
+  size_t NumMismatches = 0;
+  for(size_t Size = 0; Size <= sizeof(Data); ++Size)
+  {
+    auto const Expected = MemHashBytes(Bytes(Size), Data, 123);
+    for(size_t ChunkSize : { 1, 3, 15, 16, 17, 47, 48, 49, 96, 97, 400 })
+    {
+      hash_stream Stream;
+      HashStreamInit(&Stream, 123);
+      for(size_t Offset = 0; Offset < Size; Offset += ChunkSize)
+        HashStreamUpdate(&Stream, Bytes(Min(ChunkSize, Size - Offset)), Data + Offset);
+      if(HashStreamFinalize(Stream) != Expected)
+        ++NumMismatches;
+    }
+  }
+  REQUIRE( NumMismatches == 0 );
+
+  // Irregular chunks, including empty ones.
+  hash_stream Stream;
+  HashStreamInit(&Stream, 123);
+  size_t Offset = 0;
+  size_t ChunkIndex = 0;
+  while(Offset < sizeof(Data))
+  {
+    auto const ChunkSize = Min((ChunkIndex++ * 37) % 101, sizeof(Data) - Offset);
+    HashStreamUpdate(&Stream, Slice(ChunkSize, AsPtrToConst(&Data[Offset])));
+    Offset += ChunkSize;
+    REQUIRE( HashStreamFinalize(Stream) == MemHashBytes(Bytes(Offset), Data, 123) );
+  }
+}
+
+TEST_CASE("Hash quality", "[Hash]")
+{
+  // No collisions among consecutive integers.
+  size_t const NumKeys = 100000;
+  auto Hashes = Reinterpret<uint64*>(std::malloc(NumKeys * sizeof(uint64)));
+  Defer [=](){ std::free(Hashes); };
+  for(uint64 Key = 0; Key < NumKeys; ++Key)
+    Hashes[Key] = MemHashBytes(Bytes(sizeof(Key)), &Key);
+  std::sort(Hashes, Hashes + NumKeys);
+  REQUIRE( std::adjacent_find(Hashes, Hashes + NumKeys) == Hashes + NumKeys );
+
+  // Flipping any single input bit flips about half of the output bits.
+  for(size_t Size : { 3, 8, 16, 40, 100 })
+  {
+    uint8 Data[100] = {};
+    for(size_t Index = 0; Index < Size; ++Index)
+      Data[Index] = uint8(Index * 101);
+
+    auto const Original = MemHashBytes(Bytes(Size), Data);
+    size_t NumFlippedBits = 0;
+    for(size_t Bit = 0; Bit < Size * 8; ++Bit)
+    {
+      Data[Bit / 8] ^= uint8(1 << (Bit % 8));
+      auto Difference = Original ^ MemHashBytes(Bytes(Size), Data);
+      Data[Bit / 8] ^= uint8(1 << (Bit % 8));
+
+      while(Difference)
+      {
+        Difference &= Difference - 1;
+        ++NumFlippedBits;
+      }
+    }
+    auto const AverageFlippedBits = double(NumFlippedBits) / double(Size * 8);
+    REQUIRE( AverageFlippedBits > 28.0 );
+    REQUIRE( AverageFlippedBits < 36.0 );
+  }
+}
+
+TEST_CASE("Hash benchmark", "[.][Hash][Benchmark]")
+{
+  size_t const MaxSize = size_t(64) << 20;
+  auto Data = Reinterpret<uint8*>(std::malloc(MaxSize));
+  REQUIRE( Data != nullptr );
+  Defer [=](){ std::free(Data); };
+  for(size_t Index = 0; Index < MaxSize; ++Index)
+    Data[Index] = uint8(Index);
+
+  auto Measure = [&](size_t Size, auto Hash)
+  {
+    auto const NumRepetitions = Max(size_t(4), (size_t(1) << 30) / Size);
+    uint64 Sum = 0;
+    auto const Begin = std::chrono::high_resolution_clock::now();
+    for(size_t Repetition = 0; Repetition < NumRepetitions; ++Repetition)
+      Sum += Hash(Size, Sum & 1);
+    auto const End = std::chrono::high_resolution_clock::now();
+    REQUIRE( Sum != 1 );
+    auto const Seconds = std::chrono::duration<double>(End - Begin).count();
+    return double(Size) * double(NumRepetitions) / Seconds / 1e9;
+  };
+
+  std::printf("Hash benchmark (GB/s)\n");
+  std::printf("%12s %10s %10s\n", "Size", "OneShot", "Streaming");
+  for(size_t Size = 8; Size <= MaxSize; Size *= 4)
+  {
+    auto const OneShot = Measure(Size, [&](size_t Num, uint64 Seed){ return MemHashBytes(Bytes(Num), Data, Seed); });
+    auto const Streaming = Measure(Size, [&](size_t Num, uint64 Seed)
+    {
+      hash_stream Stream;
+      HashStreamInit(&Stream, Seed);
+      for(size_t Offset = 0; Offset < Num; Offset += 4096)
+        HashStreamUpdate(&Stream, Bytes(Min(size_t(4096), Num - Offset)), Data + Offset);
+      return HashStreamFinalize(Stream);
+    });
+    std::printf("%12zu %10.2f %10.2f\n", Size, OneShot, Streaming);
+  }
+}
+
+TEST_CASE("CRC-32C", "[Hash]")
+{
+  size_t const MaxSize = 3 * 8192 * 2 + 1000;
+  auto Data = Reinterpret<uint8*>(std::malloc(MaxSize + 8));
+  REQUIRE( Data != nullptr );
+  Defer [=](){ std::free(Data); };
+  for(size_t Index = 0; Index < MaxSize + 8; ++Index)
+    Data[Index] = uint8(Index * 131 + (Index >> 9));
+
+  uint32 const FeatureMasks[] = { ~uint32(0), Cpu_SSE2 };
+  Defer [=](){ CpuRestrictFeatures(~uint32(0)); };
+  uint32 Checksums[2][64];
+
+  for(size_t MaskIndex = 0; MaskIndex < 2; ++MaskIndex)
+  {
+    CpuRestrictFeatures(FeatureMasks[MaskIndex]);
+
+    // Check values from RFC 3720, B.4.
+    uint8 Pattern[32];
+    std::memset(Pattern, 0, sizeof(Pattern));
+    REQUIRE( MemCrc32c(Bytes(sizeof(Pattern)), Pattern) == 0x8A9136AA );
+    std::memset(Pattern, 0xFF, sizeof(Pattern));
+    REQUIRE( MemCrc32c(Bytes(sizeof(Pattern)), Pattern) == 0x62A8AB43 );
+    for(size_t Index = 0; Index < sizeof(Pattern); ++Index)
+      Pattern[Index] = uint8(Index);
+    REQUIRE( SliceCrc32c(Slice(Pattern)) == 0x46DD794E );
+    REQUIRE( SliceCrc32c(SliceReinterpret<uint8 const>("123456789"_S)) == 0xE3069283 );
+    REQUIRE( MemCrc32c(Bytes(0), nullptr) == 0 );
+
+    // Sizes around the block sizes of the interleaved loops, at all
+    // alignments.
+    size_t const Sizes[] = { 1, 7, 8, 9, 255, 767, 768, 769, 1000, 3 * 8192 - 1, 3 * 8192, 3 * 8192 + 1, MaxSize };
+    size_t NumChecksums = 0;
+    for(size_t Size : Sizes)
+    {
+      for(size_t Offset = 0; Offset < 8; Offset += 3)
+        Checksums[MaskIndex][NumChecksums++] = MemCrc32c(Bytes(Size), Data + Offset);
+    }
+
+    // Chained updates over uneven pieces.
+    uint32 Crc = 0;
+    size_t Offset = 0;
+    size_t PieceIndex = 0;
+    while(Offset < MaxSize)
+    {
+      auto const PieceSize = Min((PieceIndex++ * 1237) % 9001, MaxSize - Offset);
+      Crc = SliceCrc32cUpdate(Crc, Slice(PieceSize, AsPtrToConst(Data + Offset)));
+      Offset += PieceSize;
+    }
+    REQUIRE( Crc == MemCrc32c(Bytes(MaxSize), Data) );
+
+    // A single flipped bit changes the checksum.
+    Data[MaxSize / 2] ^= 0x10;
+    REQUIRE( Crc != MemCrc32c(Bytes(MaxSize), Data) );
+    Data[MaxSize / 2] ^= 0x10;
+  }
+
+  // The table fallback and the crc32 instruction agree.
+  REQUIRE( std::memcmp(Checksums[0], Checksums[1], 13 * 3 * sizeof(uint32)) == 0 );
+}
+
+TEST_CASE("CRC-32C benchmark", "[.][Hash][Benchmark]")
+{
+  size_t const MaxSize = size_t(64) << 20;
+  auto Data = Reinterpret<uint8*>(std::malloc(MaxSize));
+  REQUIRE( Data != nullptr );
+  Defer [=](){ std::free(Data); };
+  for(size_t Index = 0; Index < MaxSize; ++Index)
+    Data[Index] = uint8(Index);
+
+  auto Measure = [&](size_t Size)
+  {
+    auto const NumRepetitions = Max(size_t(4), (size_t(1) << 30) / Size);
+    uint32 Crc = 0;
+    auto const Begin = std::chrono::high_resolution_clock::now();
+    for(size_t Repetition = 0; Repetition < NumRepetitions; ++Repetition)
+      Crc = MemCrc32cUpdate(Crc, Bytes(Size), Data);
+    auto const End = std::chrono::high_resolution_clock::now();
+    REQUIRE( Crc != 1 );
+    auto const Seconds = std::chrono::duration<double>(End - Begin).count();
+    return double(Size) * double(NumRepetitions) / Seconds / 1e9;
+  };
+
+  Defer [=](){ CpuRestrictFeatures(~uint32(0)); };
+
+  std::printf("CRC-32C benchmark (GB/s)\n");
+  std::printf("%12s %10s %10s\n", "Size", "Table", "SSE4.2");
+  for(size_t Size = 8; Size <= MaxSize; Size *= 4)
+  {
+    CpuRestrictFeatures(Cpu_SSE2);
+    auto const Table = Measure(Size);
+    CpuRestrictFeatures(~uint32(0));
+    auto const Hardware = Measure(Size);
+    std::printf("%12zu %10.2f %10.2f\n", Size, Table, Hardware);
+  }
+}
@@ -0,0 +1,288 @@
+#include <Backbone/Heap.hpp>
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+TEST_CASE("Heap allocation", "[Heap]")
+{
+  heap Heap;
+  HeapInit(&Heap, MiB(16));
+  Defer [&](){ HeapFinalize(&Heap); };
+
+  SECTION("Small allocations")
+  {
+    auto A = Reinterpret<uint8*>(HeapAllocate(&Heap, Bytes(16), 16));
+    auto B = Reinterpret<uint8*>(HeapAllocate(&Heap, Bytes(16), 16));
+    auto C = Reinterpret<uint8*>(HeapAllocate(&Heap, Bytes(100), 8));
+    REQUIRE( A != nullptr );
+    REQUIRE( B != nullptr );
+    REQUIRE( C != nullptr );
+    REQUIRE( A != B );
+    REQUIRE( (B >= A + 16 || A >= B + 16) );
+
+    MemSetBytes(Bytes(16), A, 0xAA);
+    MemSetBytes(Bytes(16), B, 0xBB);
+    MemSetBytes(Bytes(100), C, 0xCC);
+    REQUIRE( A[15] == 0xAA );
+    REQUIRE( B[0] == 0xBB );
+    REQUIRE( C[99] == 0xCC );
+
+    HeapFree(&Heap, B);
+
+    // The freed slot is reused right away.
+    auto D = HeapAllocate(&Heap, Bytes(10), 4);
+    REQUIRE( D == B );
+
+    HeapFree(&Heap, A);
+    HeapFree(&Heap, C);
+    HeapFree(&Heap, D);
+  }
+
+  SECTION("Alignment")
+  {
+    for(size_t Alignment = 1; Alignment <= 4096; Alignment *= 2)
+    {
+      auto Ptr = HeapAllocate(&Heap, Bytes(24), Alignment);
+      REQUIRE( Ptr != nullptr );
+      REQUIRE( Reinterpret<size_t>(Ptr) % Alignment == 0 );
+      HeapFree(&Heap, Ptr);
+    }
+  }
+
+  SECTION("Large allocations")
+  {
+    auto Ptr = Reinterpret<uint8*>(HeapAllocate(&Heap, KiB(100), 64));
+    REQUIRE( Ptr != nullptr );
+    REQUIRE( Reinterpret<size_t>(Ptr) % 64 == 0 );
+    MemSetBytes(KiB(100), Ptr, 1);
+    REQUIRE( Ptr[ToBytes(KiB(100)) - 1] == 1 );
+    HeapFree(&Heap, Ptr);
+  }
+
+  SECTION("Many slabs")
+  {
+    // Enough 64 byte allocations to fill several slabs.
+    static void* Ptrs[5000];
+    for(auto& Ptr : Ptrs)
+    {
+      Ptr = HeapAllocate(&Heap, Bytes(64), 16);
+      REQUIRE( Ptr != nullptr );
+      *Reinterpret<void**>(Ptr) = &Ptr;
+    }
+
+    for(auto& Ptr : Ptrs)
+    {
+      REQUIRE( *Reinterpret<void**>(Ptr) == &Ptr );
+    }
+
+    // Free every other allocation first to exercise partially used slabs.
+    for(size_t Index = 0; Index < ArrayCount(Ptrs); Index += 2)
+      HeapFree(&Heap, Ptrs[Index]);
+    for(size_t Index = 1; Index < ArrayCount(Ptrs); Index += 2)
+      HeapFree(&Heap, Ptrs[Index]);
+
+    REQUIRE( Heap.PartialSlabs[2] == nullptr );
+    REQUIRE( Heap.EmptySlabs != nullptr );
+
+    // Empty slabs are reused for other size classes.
+    auto const UsedBefore = ArenaUsed(Heap.Slabs);
+    auto Ptr = HeapAllocate(&Heap, Bytes(512), 16);
+    REQUIRE( ArenaUsed(Heap.Slabs) == UsedBefore );
+    HeapFree(&Heap, Ptr);
+  }
+}
+
+TEST_CASE("Heap without address space for slabs", "[Heap]")
+{
+  SECTION("Nothing reserved")
+  {
+    heap Heap;
+    HeapInit(&Heap, Bytes(0));
+    Defer [&](){ HeapFinalize(&Heap); };
+
+    auto A = HeapAllocate(&Heap, Bytes(16), 16);
+    auto B = HeapAllocate(&Heap, Bytes(100), 64);
+    REQUIRE( A != nullptr );
+    REQUIRE( B != nullptr );
+    REQUIRE( Reinterpret<size_t>(B) % 64 == 0 );
+    MemSetBytes(Bytes(100), B, 0xBB);
+    HeapFree(&Heap, A);
+    HeapFree(&Heap, B);
+  }
+
+  SECTION("Slabs exhausted")
+  {
+    heap Heap;
+    HeapInit(&Heap, Bytes(Heap_SlabSize));
+    Defer [&](){ HeapFinalize(&Heap); };
+
+    // More 1 KiB slots than a single slab holds.
+    void* Ptrs[2 * Heap_SlabSize / 1024];
+    for(auto& Ptr : Ptrs)
+    {
+      Ptr = HeapAllocate(&Heap, Bytes(1024), 16);
+      REQUIRE( Ptr != nullptr );
+      *Reinterpret<void**>(Ptr) = &Ptr;
+    }
+
+    for(auto& Ptr : Ptrs)
+    {
+      REQUIRE( *Reinterpret<void**>(Ptr) == &Ptr );
+      HeapFree(&Heap, Ptr);
+    }
+  }
+}
+
+TEST_CASE("Process-wide heap", "[Heap]")
+{
+  auto Ints = Reinterpret<int*>(MemAllocate(SizeOf<int>() * 10, alignof(int)));
+  REQUIRE( Ints != nullptr );
+  MemConstruct(10, Ints, 42);
+  REQUIRE( Ints[9] == 42 );
+  MemFree(Ints);
+
+  MemFree(nullptr);
+}
+
+TEST_CASE("Process-wide heap from many threads", "[Heap]")
+{
+  // Memory allocated on one thread and freed on another must end up back in
+  // the process-wide heap eventually.
+  size_t const NumThreads = 8;
+  size_t const NumPerThread = 1000;
+  void* Ptrs[NumThreads][NumPerThread];
+
+  std::vector<std::thread> Threads;
+  for(size_t ThreadIndex = 0; ThreadIndex < NumThreads; ++ThreadIndex)
+  {
+    Threads.emplace_back([&, ThreadIndex]()
+    {
+      for(size_t Index = 0; Index < NumPerThread; ++Index)
+      {
+        auto const Size = 16 + (Index % 8) * 32;
+        auto Ptr = Reinterpret<uint8*>(MemAllocate(Bytes(Size), 16));
+        MemSetBytes(Bytes(Size), Ptr, int(ThreadIndex));
+        Ptrs[ThreadIndex][Index] = Ptr;
+      }
+    });
+  }
+  for(auto& Thread : Threads) Thread.join();
+  Threads.clear();
+
+  for(size_t ThreadIndex = 0; ThreadIndex < NumThreads; ++ThreadIndex)
+  {
+    for(size_t Index = 0; Index < NumPerThread; ++Index)
+    {
+      auto const Size = 16 + (Index % 8) * 32;
+      auto Ptr = Reinterpret<uint8*>(Ptrs[ThreadIndex][Index]);
+      REQUIRE( Ptr[0] == ThreadIndex );
+      REQUIRE( Ptr[Size - 1] == ThreadIndex );
+    }
+  }
+
+  // Free everything from other threads than the one that allocated it.
+  for(size_t ThreadIndex = 0; ThreadIndex < NumThreads; ++ThreadIndex)
+  {
+    Threads.emplace_back([&, ThreadIndex]()
+    {
+      for(auto Ptr : Ptrs[(ThreadIndex + 1) % NumThreads])
+        MemFree(Ptr);
+    });
+  }
+  for(auto& Thread : Threads) Thread.join();
+
+  MemFlushThreadCache();
+}
+
+TEST_CASE("Heap benchmark", "[.][Heap][Benchmark]")
+{
+  // Mostly 16 to 256 byte allocations with the occasional bigger one.
+  size_t const NumAllocations = 1000000;
+  size_t const NumLive = 1024;
+  auto Sizes = Reinterpret<size_t*>(std::malloc(NumAllocations * sizeof(size_t)));
+  Defer [=](){ std::free(Sizes); };
+  {
+    std::mt19937 Random(1337);
+    std::uniform_int_distribution<size_t> Small(16, 256);
+    std::uniform_int_distribution<size_t> Big(257, 1024);
+    std::uniform_int_distribution<int> Percent(0, 99);
+    for(size_t Index = 0; Index < NumAllocations; ++Index)
+      Sizes[Index] = Percent(Random) < 90 ? Small(Random) : Big(Random);
+  }
+
+  void* Live[NumLive] = {};
+
+  auto Measure = [&](auto Allocate, auto Free)
+  {
+    auto const Begin = std::chrono::high_resolution_clock::now();
+    for(size_t Index = 0; Index < NumAllocations; ++Index)
+    {
+      auto& Slot = Live[Index % NumLive];
+      Free(Slot);
+      Slot = Allocate(Sizes[Index]);
+    }
+    for(auto& Slot : Live)
+    {
+      Free(Slot);
+      Slot = nullptr;
+    }
+    auto const End = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(End - Begin).count() / NumAllocations;
+  };
+
+  auto const MallocTime = Measure([](size_t Size){ return std::malloc(Size); },
+                                  [](void* Ptr){ std::free(Ptr); });
+  auto const HeapTime = Measure([](size_t Size){ return MemAllocate(Bytes(Size), 16); },
+                                [](void* Ptr){ MemFree(Ptr); });
+
+  std::printf("Heap benchmark (alloc + free, ns/op): malloc %.1f, MemAllocate %.1f\n", MallocTime, HeapTime);
+}
+
+TEST_CASE("Heap multi-threaded benchmark", "[.][Heap][Benchmark]")
+{
+  size_t const NumOperationsPerThread = 1000000;
+  size_t const NumLive = 256;
+
+  auto Measure = [&](size_t NumThreads, auto Allocate, auto Free)
+  {
+    std::vector<std::thread> Threads;
+    auto const Begin = std::chrono::high_resolution_clock::now();
+    for(size_t ThreadIndex = 0; ThreadIndex < NumThreads; ++ThreadIndex)
+    {
+      Threads.emplace_back([&, ThreadIndex]()
+      {
+        std::mt19937 Random{ uint32(ThreadIndex) };
+        std::uniform_int_distribution<size_t> Sizes(16, 256);
+        void* Live[NumLive] = {};
+        for(size_t Index = 0; Index < NumOperationsPerThread; ++Index)
+        {
+          auto& Slot = Live[Index % NumLive];
+          Free(Slot);
+          Slot = Allocate(Sizes(Random));
+        }
+        for(auto Ptr : Live) Free(Ptr);
+      });
+    }
+    for(auto& Thread : Threads) Thread.join();
+    auto const End = std::chrono::high_resolution_clock::now();
+    auto const Seconds = std::chrono::duration<double>(End - Begin).count();
+    return double(NumThreads * NumOperationsPerThread) / Seconds / 1e6;
+  };
+
+  std::printf("Heap multi-threaded benchmark (alloc + free, million ops/s)\n");
+  for(size_t NumThreads = 1; NumThreads <= 32; NumThreads *= 2)
+  {
+    auto const MallocRate = Measure(NumThreads, [](size_t Size){ return std::malloc(Size); },
+                                                [](void* Ptr){ std::free(Ptr); });
+    auto const HeapRate = Measure(NumThreads, [](size_t Size){ return MemAllocate(Bytes(Size), 16); },
+                                              [](void* Ptr){ MemFree(Ptr); });
+    std::printf("  %2zu threads: malloc %8.1f, MemAllocate %8.1f\n", NumThreads, MallocRate, HeapRate);
+  }
+}
@@ -0,0 +1,73 @@
+#include <Backbone/MappedFile.hpp>
+#include <Backbone/StringConversion.hpp>
+
+#include "catch.hpp"
+
+#include <cstdio>
+
+
+static void
+WriteTestFile(char const* FileName, slice<char const> Content)
+{
+  auto File = std::fopen(FileName, "wb");
+  REQUIRE( File != nullptr );
+  std::fwrite(Content.Ptr, 1, Content.Num, File);
+  std::fclose(File);
+}
+
+TEST_CASE("Map a file", "[MappedFile]")
+{
+  auto const FileName = "Test_MappedFile.tmp";
+  WriteTestFile(FileName, "Hello 1337 World"_S);
+  Defer [=](){ std::remove(FileName); };
+
+  SECTION("Contents")
+  {
+    auto File = MapFile(SliceFromString(FileName));
+    Defer [&](){ UnmapFile(File); };
+
+    REQUIRE( File.Num == 16 );
+    REQUIRE( File[0] == 'H' );
+    REQUIRE( File[15] == 'd' );
+
+    // Slice and string algorithms work directly on the mapped memory.
+    auto Text = SliceReinterpret<char const>(File);
+    REQUIRE( Text == "Hello 1337 World"_S );
+    REQUIRE( SliceCountUntil(Text, ' ') == 5 );
+
+    auto Number = SliceTrimFront(Text, 6);
+    REQUIRE( Convert<int>(&Number) == 1337 );
+    REQUIRE( Number == " World"_S );
+  }
+
+  SECTION("Access hints")
+  {
+    map_file_access const Hints[] = { MapFile_NormalAccess, MapFile_SequentialAccess, MapFile_RandomAccess, MapFile_WillNeed };
+    for(auto Hint : Hints)
+    {
+      auto File = MapFile(SliceFromString(FileName), Hint);
+      REQUIRE( File.Num == 16 );
+      MapFileAdvise(SliceTrimFront(File, 3), MapFile_RandomAccess);
+      MapFileAdvise(File, MapFile_DontNeed);
+
+      // Dropped pages are read back from the file.
+      REQUIRE( SliceReinterpret<char const>(File) == "Hello 1337 World"_S );
+      UnmapFile(File);
+    }
+  }
+}
+
+TEST_CASE("Map a file that can't be mapped", "[MappedFile]")
+{
+  REQUIRE( MapFile("This file does not exist.tmp"_S).Num == 0 );
+
+  // Empty files give an empty slice as well.
+  auto const FileName = "Test_MappedFile_Empty.tmp";
+  WriteTestFile(FileName, ""_S);
+  Defer [=](){ std::remove(FileName); };
+  auto File = MapFile(SliceFromString(FileName));
+  REQUIRE( File.Num == 0 );
+  UnmapFile(File);
+
+  UnmapFile({});
+}
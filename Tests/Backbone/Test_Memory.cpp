@@ -1,8 +1,15 @@
 #include <Backbone/FixedBlock.hpp>
 #include <Backbone/Memory.hpp>
+#include <Backbone/Slice.hpp>
 
 #include "catch.hpp"
 
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
 namespace
 {
   struct FooPOD {};
@@ -23,6 +30,43 @@ static_assert(IsPOD<FooPOD>(), "Expected FooPOD to be a POD type!");
 static_assert(IsPOD<BarPOD>(), "Expected BarPOD to be a POD type!");
 static_assert(!IsPOD<BazNoPOD>(), "Expected BazNoPOD to be no POD type!");
 
+namespace
+{
+  /// Trivially copyable and destructible, but not trivially constructible.
+  struct counter
+  {
+    int Value = 0;
+  };
+
+  /// Has a destructor, so none of the trivial paths apply.
+  struct checked_handle
+  {
+    int Handle = -1;
+    ~checked_handle() {}
+  };
+}
+
+template<> struct impl_is_zero_initializable<counter> { static constexpr bool Value = true; };
+
+static_assert(!IsPOD<counter>(), "Expected counter to be no POD type!");
+static_assert(!IsTriviallyDefaultConstructible<counter>(), "counter has a default member initializer.");
+static_assert(IsTriviallyCopyable<counter>(), "Expected counter to be trivially copyable.");
+static_assert(IsTriviallyDestructible<counter>(), "Expected counter to be trivially destructible.");
+static_assert(IsZeroInitializable<counter>(), "The specialization must be picked up.");
+static_assert(IsTriviallyRelocatable<counter>(), "Trivially copyable and destructible types are relocatable.");
+
+static_assert(!IsTriviallyCopyable<checked_handle>(), "checked_handle has a destructor.");
+static_assert(!IsTriviallyDestructible<checked_handle>(), "checked_handle has a destructor.");
+static_assert(!IsZeroInitializable<checked_handle>(), "checked_handle starts out as -1.");
+static_assert(!IsTriviallyRelocatable<checked_handle>(), "Types with destructors must opt in.");
+
+static_assert(IsZeroInitializable<int>(), "Expected int to be zero-initializable.");
+static_assert(IsZeroInitializable<FooPOD>(), "Expected POD types to be zero-initializable.");
+static_assert(!IsZeroInitializable<BazNoPOD>(), "Expected BazNoPOD to not be zero-initializable.");
+static_assert(!IsZeroInitializable<int FooPOD::*>(), "Null member pointers are not zero on all ABIs.");
+static_assert(IsZeroInitializable<void>() && IsTriviallyRelocatable<void const>(), "Type 'void' must be treated like bytes.");
+static_assert(IsTriviallyCopyable<void>() && IsTriviallyDestructible<void volatile>(), "Type 'void' must be treated like bytes.");
+
 TEST_CASE("Memory Construction", "[Memory]")
 {
   SECTION("Plain Old Data (POD)")
@@ -116,6 +160,43 @@ TEST_CASE("Memory Construction", "[Memory]")
   }
 }
 
+TEST_CASE("Memory construction of non-POD trivial types", "[Memory]")
+{
+  SECTION("Zero-initializable")
+  {
+    counter Counters[4];
+    MemSetBytes(Bytes(sizeof(Counters)), &Counters[0], 0xFF);
+    MemConstruct(4, &Counters[0]);
+    REQUIRE( Counters[0].Value == 0 );
+    REQUIRE( Counters[3].Value == 0 );
+
+    Counters[1].Value = 42;
+    MemConstruct(2, &Counters[2], Counters[1]);
+    REQUIRE( Counters[2].Value == 42 );
+    REQUIRE( Counters[3].Value == 42 );
+
+    MemSet(4, &Counters[0]);
+    REQUIRE( Counters[1].Value == 0 );
+    REQUIRE( Counters[3].Value == 0 );
+  }
+
+  SECTION("Not zero-initializable")
+  {
+    alignas(checked_handle) uint8 Storage[4 * sizeof(checked_handle)];
+    auto Handles = Reinterpret<checked_handle*>(&Storage[0]);
+    MemConstruct(4, Handles);
+    REQUIRE( Handles[0].Handle == -1 );
+    REQUIRE( Handles[3].Handle == -1 );
+
+    checked_handle Other[4];
+    Other[2].Handle = 7;
+    MemCopy(4, Handles, &Other[0]);
+    REQUIRE( Handles[2].Handle == 7 );
+
+    MemDestruct(4, Handles);
+  }
+}
+
 TEST_CASE("Memory Relocation", "[Memory]")
 {
   SECTION("POD types")
@@ -250,3 +331,577 @@ TEST_CASE("Memory Relocation", "[Memory]")
     }
   }
 }
+
+namespace
+{
+  int NumRelocatableDestructed = 0;
+  int NumRelocatableMoved = 0;
+
+  /// Owns a heap value, like a string or a dynamic array would.
+  struct relocatable
+  {
+    int* Value = nullptr;
+
+    relocatable() = default;
+    relocatable(int InitialValue) : Value(new int(InitialValue)) {}
+    relocatable(relocatable&& ToMove) : Value(ToMove.Value) { ToMove.Value = nullptr; ++NumRelocatableMoved; }
+    void operator =(relocatable&& ToMove) { delete Value; Value = ToMove.Value; ToMove.Value = nullptr; ++NumRelocatableMoved; }
+    ~relocatable() { delete Value; ++NumRelocatableDestructed; }
+  };
+}
+
+template<> struct impl_is_trivially_relocatable<relocatable> { static constexpr bool Value = true; };
+
+static_assert(IsTriviallyRelocatable<int>(), "POD types must be trivially relocatable.");
+static_assert(IsTriviallyRelocatable<relocatable>(), "The specialization must be picked up.");
+static_assert(IsTriviallyRelocatable<BazNoPOD>(), "Trivially copyable and destructible types are relocatable.");
+
+TEST_CASE("Memory relocation of trivially relocatable types", "[Memory]")
+{
+  alignas(relocatable) uint8 Storage[6 * sizeof(relocatable)];
+  auto Items = Reinterpret<relocatable*>(&Storage[0]);
+  for(int Index = 0; Index < 6; ++Index)
+    new (&Items[Index]) relocatable(Index);
+
+  NumRelocatableDestructed = 0;
+  NumRelocatableMoved = 0;
+
+  SECTION("MemMoveConstruct")
+  {
+    alignas(relocatable) uint8 Buffer[3 * sizeof(relocatable)];
+    auto Destination = Reinterpret<relocatable*>(&Buffer[0]);
+    MemMoveConstruct(3, Destination, &Items[3]);
+
+    // No move constructors or destructors ran, the pointers just moved.
+    REQUIRE( NumRelocatableMoved == 0 );
+    REQUIRE( NumRelocatableDestructed == 0 );
+    REQUIRE( *Destination[0].Value == 3 );
+    REQUIRE( *Destination[2].Value == 5 );
+
+    MemDestruct(3, Destination);
+    MemDestruct(3, &Items[0]);
+  }
+
+  SECTION("Overlapping MemMove")
+  {
+    // Items[0] and Items[1] get overwritten, Items[4] and Items[5] are left
+    // as relocated-from memory.
+    MemMove(4, &Items[0], &Items[2]);
+    REQUIRE( NumRelocatableMoved == 0 );
+    REQUIRE( NumRelocatableDestructed == 2 );
+    REQUIRE( *Items[0].Value == 2 );
+    REQUIRE( *Items[3].Value == 5 );
+
+    MemDestruct(4, &Items[0]);
+  }
+
+  SECTION("Non-overlapping MemMove")
+  {
+    MemMove(2, &Items[4], &Items[0]);
+    REQUIRE( NumRelocatableMoved == 0 );
+    REQUIRE( NumRelocatableDestructed == 2 );
+    REQUIRE( *Items[4].Value == 0 );
+    REQUIRE( *Items[5].Value == 1 );
+
+    MemDestruct(4, &Items[2]);
+  }
+}
+
+TEST_CASE("Memory byte copies", "[Memory]")
+{
+  // Large enough to reach the streaming loops, with some slack for offsets.
+  size_t const MaxSize = 4 * Mem_NonTemporalThreshold / 3;
+  size_t const BufferSize = MaxSize + 64;
+  auto Source = Reinterpret<uint8*>(std::malloc(BufferSize));
+  auto Destination = Reinterpret<uint8*>(std::malloc(BufferSize));
+  Defer [=](){ std::free(Source); std::free(Destination); };
+  for(size_t Index = 0; Index < BufferSize; ++Index)
+    Source[Index] = uint8(Index * 31 + Index / 251);
+
+  size_t const Sizes[] = { 0, 1, 15, 16, 31, 33, 127, 128, 129, 4096 + 77, 100000, MaxSize };
+  size_t const Offsets[] = { 0, 1, 17, 32 };
+
+  // Run everything once with and once without AVX.
+  uint32 const FeatureMasks[] = { ~uint32(0), Cpu_SSE2 };
+  Defer [=](){ CpuRestrictFeatures(~uint32(0)); };
+
+  size_t NumMismatches = 0;
+  auto CountMismatches = [&](uint8 const* Expected, uint8 const* Actual, size_t Size)
+  {
+    if(std::memcmp(Expected, Actual, Size) != 0)
+      ++NumMismatches;
+  };
+
+  for(auto Mask : FeatureMasks)
+  {
+    CpuRestrictFeatures(Mask);
+    for(auto Size : Sizes)
+    {
+      for(auto SourceOffset : Offsets)
+      {
+        for(auto DestinationOffset : Offsets)
+        {
+          auto From = Source + SourceOffset;
+          auto To = Destination + DestinationOffset;
+
+          std::memset(Destination, 0xCD, BufferSize);
+          MemCopyBytesNonOverlapping(Bytes(Size), To, From);
+          CountMismatches(From, To, Size);
+
+          std::memset(Destination, 0xCD, BufferSize);
+          MemCopyBytesNonTemporal(Bytes(Size), To, From);
+          CountMismatches(From, To, Size);
+
+          // Nothing around the copied range was touched.
+          if(DestinationOffset > 0 && To[-1] != 0xCD)
+            ++NumMismatches;
+          if(To[Size] != 0xCD)
+            ++NumMismatches;
+
+          MemSetBytesNonTemporal(Bytes(Size), To, 0x42);
+          for(size_t Index = 0; Index < Size; ++Index)
+          {
+            if(To[Index] != 0x42)
+            {
+              ++NumMismatches;
+              break;
+            }
+          }
+          if(To[Size] != 0xCD)
+            ++NumMismatches;
+        }
+      }
+    }
+  }
+
+  REQUIRE( NumMismatches == 0 );
+
+  SECTION("Overlapping copies still work")
+  {
+    uint8 Bytes[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    MemCopyBytes(::Bytes(6), &Bytes[2], &Bytes[0]);
+    uint8 const Forward[8] = { 1, 2, 1, 2, 3, 4, 5, 6 };
+    REQUIRE( std::memcmp(Bytes, Forward, 8) == 0 );
+
+    MemCopyBytes(::Bytes(6), &Bytes[0], &Bytes[2]);
+    uint8 const Backward[8] = { 1, 2, 3, 4, 5, 6, 5, 6 };
+    REQUIRE( std::memcmp(Bytes, Backward, 8) == 0 );
+  }
+}
+
+TEST_CASE("Memory pattern fill", "[Memory]")
+{
+  uint8 Pattern[100];
+  for(size_t Index = 0; Index < sizeof(Pattern); ++Index)
+    Pattern[Index] = uint8(Index + 1);
+
+  size_t const MaxSize = 100000;
+  auto Buffer = Reinterpret<uint8*>(std::malloc(MaxSize + 2));
+  Defer [=](){ std::free(Buffer); };
+
+  size_t const PatternSizes[] = { 1, 2, 3, 4, 8, 12, 16, 24, 32, 48, 64, 65, 100 };
+  size_t const Sizes[] = { 0, 1, 7, 64, 65, 1000, 4096, MaxSize };
+  uint32 const FeatureMasks[] = { ~uint32(0), Cpu_SSE2 };
+  Defer [=](){ CpuRestrictFeatures(~uint32(0)); };
+
+  size_t NumMismatches = 0;
+  for(auto Mask : FeatureMasks)
+  {
+    CpuRestrictFeatures(Mask);
+    for(auto PatternSize : PatternSizes)
+    {
+      for(auto Size : Sizes)
+      {
+        // Odd address on purpose.
+        auto Destination = Buffer + 1;
+        std::memset(Buffer, 0xCD, MaxSize + 2);
+        MemSetPatternBytes(Bytes(Size), Destination, Bytes(PatternSize), Pattern);
+        for(size_t Index = 0; Index < Size; ++Index)
+        {
+          if(Destination[Index] != Pattern[Index % PatternSize])
+          {
+            ++NumMismatches;
+            break;
+          }
+        }
+        if(Buffer[0] != 0xCD || Destination[Size] != 0xCD)
+          ++NumMismatches;
+      }
+    }
+  }
+  REQUIRE( NumMismatches == 0 );
+
+  SECTION("Pattern inside the destination")
+  {
+    uint32 Values[100];
+    Values[0] = 0xDEADBEEF;
+    MemSet(100, &Values[0], Values[0]);
+    REQUIRE( Values[99] == 0xDEADBEEF );
+
+    Values[50] = 42;
+    MemSet(100, &Values[0], Values[50]);
+    REQUIRE( Values[0] == 42 );
+    REQUIRE( Values[99] == 42 );
+  }
+
+  SECTION("Typed fills")
+  {
+    struct vec3 { float X, Y, Z; };
+    vec3 Vectors[1000];
+    MemConstruct(1000, &Vectors[0], vec3{ 1, 2, 3 });
+    REQUIRE( Vectors[0].X == 1 );
+    REQUIRE( Vectors[999].Z == 3 );
+
+    MemSet(1000, &Vectors[0], vec3{ 4, 5, 6 });
+    REQUIRE( Vectors[0].X == 4 );
+    REQUIRE( Vectors[500].Y == 5 );
+    REQUIRE( Vectors[999].Z == 6 );
+  }
+}
+
+TEST_CASE("Memory parallel copies", "[Memory]")
+{
+  size_t const MaxSize = Mem_ParallelCopyThreshold + 3 * 4096 + 100;
+  auto Source = Reinterpret<uint32*>(std::malloc(MaxSize + 8));
+  auto Destination = Reinterpret<uint32*>(std::malloc(MaxSize + 8));
+  Defer [=](){ std::free(Source); std::free(Destination); };
+  for(size_t Index = 0; Index < (MaxSize + 8) / 4; ++Index)
+    Source[Index] = uint32(Index);
+
+  // Below and above the threshold, with page-unaligned ends.
+  size_t const Sizes[] = { 4096, Mem_ParallelCopyThreshold - 4, MaxSize };
+  size_t const Offsets[] = { 0, 1, 7 };
+  size_t NumMismatches = 0;
+  for(auto Size : Sizes)
+  {
+    for(auto Offset : Offsets)
+    {
+      auto To = Reinterpret<uint8*>(Destination) + Offset;
+      auto From = Reinterpret<uint8 const*>(Source) + 8 - Offset;
+      std::memset(Destination, 0, MaxSize + 8);
+      MemCopyBytesParallel(Bytes(Size), To, From);
+      if(std::memcmp(To, From, Size) != 0)
+        ++NumMismatches;
+      if(To[Size] != 0)
+        ++NumMismatches;
+    }
+  }
+  REQUIRE( NumMismatches == 0 );
+
+  SECTION("Slices")
+  {
+    auto const Num = MaxSize / 4;
+    std::memset(Destination, 0, MaxSize);
+    REQUIRE( SliceCopyParallel(Slice(Num, Destination), Slice(Num - 1, AsPtrToConst(Source))) == Num - 1 );
+    REQUIRE( Destination[0] == 0 );
+    REQUIRE( Destination[Num / 2] == Num / 2 );
+    REQUIRE( Destination[Num - 2] == Num - 2 );
+    REQUIRE( Destination[Num - 1] == 0 );
+  }
+}
+
+TEST_CASE("Memory parallel copy benchmark", "[.][Memory][Benchmark]")
+{
+  size_t const MaxSize = size_t(2) << 30;
+  auto Source = Reinterpret<uint8*>(std::malloc(MaxSize));
+  auto Destination = Reinterpret<uint8*>(std::malloc(MaxSize));
+  REQUIRE( Source != nullptr );
+  REQUIRE( Destination != nullptr );
+  Defer [=](){ std::free(Source); std::free(Destination); };
+  std::memset(Source, 1, MaxSize);
+  std::memset(Destination, 2, MaxSize);
+
+  auto Measure = [&](size_t Size, auto Copy)
+  {
+    auto const NumRepetitions = Max(size_t(2), (size_t(4) << 30) / Size);
+    auto const Begin = std::chrono::high_resolution_clock::now();
+    for(size_t Repetition = 0; Repetition < NumRepetitions; ++Repetition)
+      Copy(Size);
+    auto const End = std::chrono::high_resolution_clock::now();
+    auto const Seconds = std::chrono::duration<double>(End - Begin).count();
+    return double(Size) * double(NumRepetitions) / Seconds / 1e9;
+  };
+
+  std::printf("Memory parallel copy benchmark (GB/s, %u hardware threads)\n", std::thread::hardware_concurrency());
+  std::printf("%12s %10s %10s %10s\n", "Size", "memcpy", "MemCopy", "Parallel");
+  for(size_t Size = size_t(Mem_ParallelCopyThreshold) / 4; Size <= MaxSize; Size *= 2)
+  {
+    auto const Libc = Measure(Size, [&](size_t Num){ std::memcpy(Destination, Source, Num); });
+    auto const Single = Measure(Size, [&](size_t Num){ MemCopyBytes(Bytes(Num), Destination, Source); });
+    auto const Parallel = Measure(Size, [&](size_t Num){ MemCopyBytesParallel(Bytes(Num), Destination, Source); });
+    std::printf("%12zu %10.2f %10.2f %10.2f\n", Size, Libc, Single, Parallel);
+  }
+}
+
+TEST_CASE("Memory batched copies", "[Memory]")
+{
+  uint8 Source[4096];
+  uint8 Destination[9000];
+  for(size_t Index = 0; Index < sizeof(Source); ++Index)
+    Source[Index] = uint8(Index * 13 + 5);
+  std::memset(Destination, 0xCD, sizeof(Destination));
+
+  // Every size from 0 to 100 bytes, plus a few big ones, at odd positions.
+  // A gap of one byte after each copy catches writes past the end.
+  mem_copy_op Ops[104];
+  size_t NumOps = 0;
+  size_t WriteOffset = 1;
+  auto AddOp = [&](size_t Size, size_t ReadOffset)
+  {
+    Ops[NumOps++] = { Bytes(Size), Destination + WriteOffset, Source + ReadOffset };
+    WriteOffset += Size + 1;
+  };
+  for(size_t Size = 0; Size <= 100; ++Size)
+    AddOp(Size, (Size * 37) % 1000);
+  AddOp(1000, 3);
+  AddOp(65, 1);
+  AddOp(2000, 2000);
+  REQUIRE( WriteOffset < sizeof(Destination) );
+
+  MemCopyBatch(Slice(NumOps, AsPtrToConst(&Ops[0])));
+
+  size_t NumMismatches = 0;
+  for(size_t Index = 0; Index < NumOps; ++Index)
+  {
+    auto const& Op = Ops[Index];
+    auto const To = Reinterpret<uint8 const*>(Op.Destination);
+    if(std::memcmp(To, Op.Source, ToBytes(Op.Size)) != 0)
+      ++NumMismatches;
+    if(To[ToBytes(Op.Size)] != 0xCD)
+      ++NumMismatches;
+  }
+  REQUIRE( NumMismatches == 0 );
+
+  // Empty batches are fine.
+  MemCopyBatch({});
+}
+
+TEST_CASE("Memory batched copy benchmark", "[.][Memory][Benchmark]")
+{
+  // Assemble a few packets from fragments of 8 to 128 bytes taken from all
+  // over a source buffer that either fits into the cache or doesn't.
+  size_t const MaxSourceSize = size_t(16) << 20;
+  size_t const NumFragments = 4096;
+  auto Source = Reinterpret<uint8*>(std::malloc(MaxSourceSize));
+  auto Destination = Reinterpret<uint8*>(std::malloc(NumFragments * 128));
+  auto Ops = Reinterpret<mem_copy_op*>(std::malloc(NumFragments * sizeof(mem_copy_op)));
+  Defer [=](){ std::free(Source); std::free(Destination); std::free(Ops); };
+  std::memset(Source, 1, MaxSourceSize);
+  std::memset(Destination, 2, NumFragments * 128);
+
+  auto Measure = [&](auto Copy)
+  {
+    size_t const NumRepetitions = 1000;
+    auto const Begin = std::chrono::high_resolution_clock::now();
+    for(size_t Repetition = 0; Repetition < NumRepetitions; ++Repetition)
+      Copy();
+    auto const End = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(End - Begin).count() / double(NumRepetitions * NumFragments);
+  };
+
+  std::printf("Memory batched copy benchmark (ns/fragment)\n");
+  std::printf("%12s %10s %12s %12s\n", "Source size", "memcpy", "MemCopyBytes", "MemCopyBatch");
+  size_t const SourceSizes[] = { size_t(64) << 10, MaxSourceSize };
+  for(auto SourceSize : SourceSizes)
+  {
+    uint32 Random = 1337;
+    auto NextRandom = [&](){ Random = Random * 1664525u + 1013904223u; return Random >> 8; };
+    size_t WriteOffset = 0;
+    for(size_t Index = 0; Index < NumFragments; ++Index)
+    {
+      auto const Size = 8 + NextRandom() % 121;
+      auto const ReadOffset = NextRandom() % (SourceSize - 128);
+      Ops[Index] = { Bytes(Size), Destination + WriteOffset, Source + ReadOffset };
+      WriteOffset += Size;
+    }
+
+    auto const Libc = Measure([&]()
+    {
+      for(size_t Index = 0; Index < NumFragments; ++Index)
+        std::memcpy(Ops[Index].Destination, Ops[Index].Source, ToBytes(Ops[Index].Size));
+    });
+    auto const Single = Measure([&]()
+    {
+      for(size_t Index = 0; Index < NumFragments; ++Index)
+        MemCopyBytes(Ops[Index].Size, Ops[Index].Destination, Ops[Index].Source);
+    });
+    auto const Batch = Measure([&](){ MemCopyBatch(Slice(NumFragments, AsPtrToConst(Ops))); });
+    std::printf("%12zu %10.2f %12.2f %12.2f\n", SourceSize, Libc, Single, Batch);
+  }
+}
+
+TEST_CASE("Memory byte comparison", "[Memory]")
+{
+  uint8 A[300];
+  uint8 B[300];
+  for(size_t Index = 0; Index < sizeof(A); ++Index)
+    A[Index] = B[Index] = uint8(Index * 7);
+
+  uint32 const FeatureMasks[] = { ~uint32(0), Cpu_SSE2 };
+  Defer [=](){ CpuRestrictFeatures(~uint32(0)); };
+
+  size_t NumMismatches = 0;
+  for(auto Mask : FeatureMasks)
+  {
+    CpuRestrictFeatures(Mask);
+
+    // Every size up to the full buffer, starting at an odd address, with no
+    // difference and with a difference at a few positions.
+    for(size_t Size = 0; Size < sizeof(A) - 1; ++Size)
+    {
+      if(MemFindFirstDifference(Bytes(Size), A + 1, B + 1) != Size)
+        ++NumMismatches;
+      if(!MemEqualBytes(Bytes(Size), A + 1, B + 1) || MemCompareBytes(Bytes(Size), A + 1, B + 1) != 0)
+        ++NumMismatches;
+
+      size_t const Positions[] = { 0, Size / 3, Size / 2, Size - 1 };
+      for(auto Position : Positions)
+      {
+        if(Position >= Size)
+          continue;
+
+        B[1 + Position] += 1;
+        if(MemFindFirstDifference(Bytes(Size), A + 1, B + 1) != Position)
+          ++NumMismatches;
+        if(MemEqualBytes(Bytes(Size), A + 1, B + 1))
+          ++NumMismatches;
+        if(Sign(MemCompareBytes(Bytes(Size), A + 1, B + 1)) != Sign(std::memcmp(A + 1, B + 1, Size)))
+          ++NumMismatches;
+        B[1 + Position] -= 1;
+      }
+    }
+  }
+  REQUIRE( NumMismatches == 0 );
+
+  // Same pointer.
+  REQUIRE( MemFindFirstDifference(Bytes(300), A, A) == 300 );
+
+  // memcmp compares unsigned bytes.
+  uint8 const Small[] = { 1, 0x01 };
+  uint8 const Big[] = { 1, 0xFF };
+  REQUIRE( MemCompareBytes(Bytes(2), Small, Big) < 0 );
+  REQUIRE( MemCompareBytes(Bytes(2), Big, Small) > 0 );
+}
+
+TEST_CASE("Memory byte comparison benchmark", "[.][Memory][Benchmark]")
+{
+  size_t const MaxSize = size_t(256) << 20;
+  auto A = Reinterpret<uint8*>(std::malloc(MaxSize));
+  auto B = Reinterpret<uint8*>(std::malloc(MaxSize));
+  REQUIRE( A != nullptr );
+  REQUIRE( B != nullptr );
+  Defer [=](){ std::free(A); std::free(B); };
+  std::memset(A, 7, MaxSize);
+  std::memset(B, 7, MaxSize);
+
+  auto Measure = [&](size_t Size, auto Compare)
+  {
+    auto const NumRepetitions = Max(size_t(1), (size_t(1) << 30) / Size);
+    size_t Sum = 0;
+    auto const Begin = std::chrono::high_resolution_clock::now();
+    for(size_t Repetition = 0; Repetition < NumRepetitions; ++Repetition)
+      Sum += size_t(Compare(Size));
+    auto const End = std::chrono::high_resolution_clock::now();
+    REQUIRE( Sum != 1 ); // Keep the result alive.
+    auto const Seconds = std::chrono::duration<double>(End - Begin).count();
+    return double(Size) * double(NumRepetitions) / Seconds / 1e9;
+  };
+
+  // Otherwise the compiler hoists the memcmp calls out of the loop.
+  int (* volatile LibcCompare)(void const*, void const*, size_t) = &std::memcmp;
+
+  // The difference is in the very last byte, so everything has to be read.
+  std::printf("Memory byte comparison benchmark (GB/s)\n");
+  std::printf("%12s %10s %10s %10s\n", "Size", "memcmp", "MemCompare", "FindDiff");
+  for(size_t Size = 16; Size <= MaxSize; Size *= 4)
+  {
+    B[Size - 1] = 8;
+    auto const Libc = Measure(Size, [&](size_t Num){ return LibcCompare(A, B, Num); });
+    auto const Compare = Measure(Size, [&](size_t Num){ return MemCompareBytes(Bytes(Num), A, B); });
+    auto const FindDifference = Measure(Size, [&](size_t Num){ return MemFindFirstDifference(Bytes(Num), A, B); });
+    B[Size - 1] = 7;
+    std::printf("%12zu %10.2f %10.2f %10.2f\n", Size, Libc, Compare, FindDifference);
+  }
+}
+
+TEST_CASE("Memory pattern fill benchmark", "[.][Memory][Benchmark]")
+{
+  size_t const MaxNum = 100000000;
+  auto Buffer = std::malloc(MaxNum * 16);
+  REQUIRE( Buffer != nullptr );
+  Defer [=](){ std::free(Buffer); };
+  std::memset(Buffer, 0, MaxNum * 16);
+
+  auto Measure = [&](size_t Num, auto Fill)
+  {
+    auto const NumRepetitions = Max(size_t(1), size_t(100000000) / Num);
+    auto const Begin = std::chrono::high_resolution_clock::now();
+    for(size_t Repetition = 0; Repetition < NumRepetitions; ++Repetition)
+      Fill(Num);
+    auto const End = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(End - Begin).count() / double(NumRepetitions * Num);
+  };
+
+  auto Run = [&](auto Item)
+  {
+    using item = decltype(Item);
+    auto Items = Reinterpret<item*>(Buffer);
+    std::printf("%zu byte items (ns/element)\n", sizeof(item));
+    std::printf("%12s %12s %12s\n", "Num", "Per item", "Pattern");
+    for(size_t Num = 1000; Num <= MaxNum; Num *= 10)
+    {
+      // What MemConstruct used to do.
+      auto const PerItem = Measure(Num, [&](size_t Count)
+      {
+        for(size_t Index = 0; Index < Count; ++Index)
+          MemCopyBytes(SizeOf<item>(), &Items[Index], &Item);
+      });
+      auto const Pattern = Measure(Num, [&](size_t Count){ MemConstruct(Count, Items, Item); });
+      std::printf("%12zu %12.3f %12.3f\n", Num, PerItem, Pattern);
+    }
+  };
+
+  struct item8 { uint32 A, B; };
+  struct item16 { uint32 A, B, C, D; };
+  Run(uint32(0x12345678));
+  Run(item8{ 1, 2 });
+  Run(item16{ 1, 2, 3, 4 });
+}
+
+TEST_CASE("Memory byte copy benchmark", "[.][Memory][Benchmark]")
+{
+  // Sizes from 16 B to 1 GiB. Small sizes are repeated to get measurable times.
+  size_t const MaxSize = size_t(1) << 30;
+  auto Source = Reinterpret<uint8*>(std::malloc(MaxSize));
+  auto Destination = Reinterpret<uint8*>(std::malloc(MaxSize));
+  REQUIRE( Source != nullptr );
+  REQUIRE( Destination != nullptr );
+  Defer [=](){ std::free(Source); std::free(Destination); };
+
+  // Fault all pages in up front.
+  std::memset(Source, 1, MaxSize);
+  std::memset(Destination, 2, MaxSize);
+
+  auto Measure = [&](size_t Size, auto Copy)
+  {
+    auto const NumRepetitions = Max(size_t(1), (size_t(1) << 31) / Size / 4);
+    auto const Begin = std::chrono::high_resolution_clock::now();
+    for(size_t Repetition = 0; Repetition < NumRepetitions; ++Repetition)
+      Copy(Size);
+    auto const End = std::chrono::high_resolution_clock::now();
+    auto const Seconds = std::chrono::duration<double>(End - Begin).count();
+    return double(Size) * double(NumRepetitions) / Seconds / 1e9;
+  };
+
+  std::printf("Memory byte copy benchmark (GB/s)\n");
+  std::printf("%12s %10s %10s %10s %10s %10s\n", "Size", "memcpy", "MemCopy", "NonTemp", "memset", "MemSet");
+  for(size_t Size = 16; Size <= MaxSize; Size *= 4)
+  {
+    auto const LibcCopy = Measure(Size, [&](size_t Num){ std::memcpy(Destination, Source, Num); });
+    auto const Copy = Measure(Size, [&](size_t Num){ MemCopyBytes(Bytes(Num), Destination, Source); });
+    auto const NonTemporal = Measure(Size, [&](size_t Num){ MemCopyBytesNonTemporal(Bytes(Num), Destination, Source); });
+    auto const LibcSet = Measure(Size, [&](size_t Num){ std::memset(Destination, int(Num), Num); });
+    auto const Set = Measure(Size, [&](size_t Num){ MemSetBytes(Bytes(Num), Destination, int(Num)); });
+    std::printf("%12zu %10.2f %10.2f %10.2f %10.2f %10.2f\n", Size, LibcCopy, Copy, NonTemporal, LibcSet, Set);
+  }
+}
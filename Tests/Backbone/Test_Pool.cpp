@@ -0,0 +1,100 @@
+#include <Backbone/Pool.hpp>
+
+#include "catch.hpp"
+
+
+TEST_CASE("Pool of POD", "[Pool]")
+{
+  pool<int> Ints;
+  PoolInit(&Ints, Bytes(64));
+  Defer [&](){ PoolFinalize(&Ints); };
+
+  REQUIRE( Ints.NumSlotsPerBlock > 0 );
+
+  SECTION("Create and destroy")
+  {
+    auto A = PoolCreate(&Ints);
+    auto B = PoolCreate(&Ints, 42);
+    REQUIRE( *A == 0 );
+    REQUIRE( *B == 42 );
+    REQUIRE( A != B );
+    REQUIRE( Ints.NumLive == 2 );
+
+    PoolDestroy(&Ints, B);
+    REQUIRE( Ints.NumLive == 1 );
+
+    // The most recently freed slot is reused first.
+    auto C = PoolCreate(&Ints, 1337);
+    REQUIRE( C == B );
+    REQUIRE( *C == 1337 );
+  }
+
+  SECTION("Many blocks")
+  {
+    int* Objects[100];
+    for(int Index = 0; Index < 100; ++Index)
+    {
+      Objects[Index] = PoolCreate(&Ints, Index);
+      REQUIRE( Reinterpret<size_t>(Objects[Index]) % alignof(int) == 0 );
+    }
+    REQUIRE( Ints.NumLive == 100 );
+
+    for(int Index = 0; Index < 100; ++Index)
+    {
+      REQUIRE( *Objects[Index] == Index );
+    }
+
+    for(int Index = 0; Index < 100; ++Index)
+    {
+      PoolDestroy(&Ints, Objects[Index]);
+    }
+    REQUIRE( Ints.NumLive == 0 );
+  }
+}
+
+TEST_CASE("Pool of non-POD", "[Pool]")
+{
+  static int NumAlive;
+  NumAlive = 0;
+
+  struct foo
+  {
+    uint64 Value;
+
+    foo() : Value(1) { ++NumAlive; }
+    foo(uint64 Value) : Value(Value) { ++NumAlive; }
+    ~foo() { --NumAlive; }
+  };
+  static_assert(!IsPOD<foo>(), "foo must NOT be POD!");
+
+  pool<foo> Foos;
+  PoolInit(&Foos);
+  Defer [&](){ PoolFinalize(&Foos); };
+
+  auto A = PoolCreate(&Foos);
+  auto B = PoolCreate(&Foos, 42ULL);
+  REQUIRE( NumAlive == 2 );
+  REQUIRE( A->Value == 1 );
+  REQUIRE( B->Value == 42 );
+
+  PoolDestroy(&Foos, A);
+  REQUIRE( NumAlive == 1 );
+
+  PoolDestroy(&Foos, B);
+  REQUIRE( NumAlive == 0 );
+  REQUIRE( Foos.NumLive == 0 );
+}
+
+TEST_CASE("Pool of over-aligned types", "[Pool]")
+{
+  pool<cache_line_padded<uint64>> Counters;
+  PoolInit(&Counters, KiB(1));
+  Defer [&](){ PoolFinalize(&Counters); };
+
+  for(int Index = 0; Index < 64; ++Index)
+  {
+    auto Counter = PoolCreate(&Counters);
+    REQUIRE( Counter != nullptr );
+    REQUIRE( IsAligned(Counter, CacheLineSize) );
+  }
+}
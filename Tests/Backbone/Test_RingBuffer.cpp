@@ -0,0 +1,114 @@
+#include <Backbone/RingBuffer.hpp>
+#include <Backbone/StringConversion.hpp>
+
+#include "catch.hpp"
+
+
+TEST_CASE("Ring buffer basics", "[RingBuffer]")
+{
+  ring_buffer Buffer;
+  REQUIRE( RingBufferInit(&Buffer, Bytes(100)) );
+  Defer [&](){ RingBufferFinalize(&Buffer); };
+
+  REQUIRE( Buffer.Capacity >= 100 );
+  REQUIRE( RingBufferReadable(Buffer).Num == 0 );
+  REQUIRE( RingBufferWritable(Buffer).Num == Buffer.Capacity );
+
+  // Both mappings show the same memory.
+  Buffer.Data[0] = 42;
+  REQUIRE( Buffer.Data[Buffer.Capacity] == 42 );
+  Buffer.Data[2 * Buffer.Capacity - 1] = 123;
+  REQUIRE( Buffer.Data[Buffer.Capacity - 1] == 123 );
+
+  auto const Capacity = Buffer.Capacity;
+  REQUIRE( RingBufferWrite(&Buffer, SliceReinterpret<uint8 const>("Hello"_S)) == 5 );
+  REQUIRE( RingBufferReadable(Buffer) == SliceReinterpret<uint8 const>("Hello"_S) );
+  REQUIRE( RingBufferWritable(Buffer).Num == Capacity - 5 );
+
+  RingBufferConsume(&Buffer, 2);
+  REQUIRE( RingBufferReadable(Buffer) == SliceReinterpret<uint8 const>("llo"_S) );
+
+  RingBufferConsume(&Buffer, 3);
+  REQUIRE( RingBufferReadable(Buffer).Num == 0 );
+  REQUIRE( RingBufferWritable(Buffer).Num == Capacity );
+}
+
+TEST_CASE("Ring buffer wraps around contiguously", "[RingBuffer]")
+{
+  ring_buffer Buffer;
+  REQUIRE( RingBufferInit(&Buffer, Bytes(1)) );
+  Defer [&](){ RingBufferFinalize(&Buffer); };
+  auto const Capacity = Buffer.Capacity;
+
+  // Move the read position close to the end.
+  auto Free = RingBufferWritable(Buffer);
+  MemSetBytes(Bytes(Capacity - 4), Free.Ptr, 'x');
+  RingBufferCommit(&Buffer, Capacity - 4);
+  RingBufferWrite(&Buffer, SliceReinterpret<uint8 const>("AB"_S));
+  RingBufferConsume(&Buffer, Capacity - 4);
+
+  // This crosses the end of the buffer.
+  REQUIRE( RingBufferWrite(&Buffer, SliceReinterpret<uint8 const>("CDEFGH"_S)) == 6 );
+  REQUIRE( RingBufferReadable(Buffer) == SliceReinterpret<uint8 const>("ABCDEFGH"_S) );
+  REQUIRE( Buffer.Data[0] == 'E' );
+
+  // The free space after the wrapped data is contiguous as well.
+  Free = RingBufferWritable(Buffer);
+  REQUIRE( Free.Num == Capacity - 8 );
+  REQUIRE( Free.Ptr == Buffer.Data + 4 );
+
+  // Full.
+  MemSetBytes(Bytes(Free.Num), Free.Ptr, 'y');
+  RingBufferCommit(&Buffer, Free.Num);
+  REQUIRE( RingBufferWritable(Buffer).Num == 0 );
+  REQUIRE( RingBufferWrite(&Buffer, SliceReinterpret<uint8 const>("Z"_S)) == 0 );
+  REQUIRE( RingBufferReadable(Buffer).Num == Capacity );
+}
+
+TEST_CASE("Ring buffer streaming parser", "[RingBuffer]")
+{
+  ring_buffer Buffer;
+  REQUIRE( RingBufferInit(&Buffer, Bytes(1)) );
+  Defer [&](){ RingBufferFinalize(&Buffer); };
+
+  // Feed a long list of numbers in odd-sized chunks and parse them straight
+  // out of the buffer, including the ones that straddle the wrap point.
+  char Chunk[1000];
+  int NextToWrite = 0;
+  int NextToRead = 0;
+  int const NumNumbers = 20000;
+  while(NextToRead < NumNumbers)
+  {
+    // Produce.
+    size_t ChunkSize = 0;
+    while(NextToWrite < NumNumbers && ChunkSize < 900)
+    {
+      auto Written = Convert<slice<char>>(NextToWrite++, Slice(Chunk + ChunkSize, Chunk + sizeof(Chunk)));
+      ChunkSize += Written.Num;
+      Chunk[ChunkSize++] = ';';
+    }
+    auto Pending = SliceReinterpret<uint8 const>(Slice(ChunkSize, AsPtrToConst(&Chunk[0])));
+    while(Pending.Num)
+    {
+      auto const NumWritten = RingBufferWrite(&Buffer, Pending);
+      Pending = SliceTrimFront(Pending, NumWritten);
+
+      // Consume all complete numbers.
+      auto Text = SliceReinterpret<char const>(RingBufferReadable(Buffer));
+      while(true)
+      {
+        auto const Length = SliceCountUntil(Text, ';');
+        if(Length == INVALID_INDEX)
+          break;
+
+        auto Number = Slice(Text, 0, Length);
+        REQUIRE( Convert<int>(Number) == NextToRead );
+        ++NextToRead;
+        Text = SliceTrimFront(Text, Length + 1);
+        RingBufferConsume(&Buffer, Length + 1);
+      }
+    }
+  }
+
+  REQUIRE( RingBufferReadable(Buffer).Num == 0 );
+}
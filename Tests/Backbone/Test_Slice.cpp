@@ -174,6 +174,107 @@ TEST_CASE("Slice Equality", "[Slice]")
 
     REQUIRE(Foo != Bar);
   }
+
+  SECTION("Long slices")
+  {
+    uint16 A[300];
+    uint16 B[300];
+    for(uint16 Index = 0; Index < 300; ++Index)
+      A[Index] = B[Index] = Index;
+
+    REQUIRE(Slice(300, &A[0]) == Slice(300, &B[0]));
+    REQUIRE(Slice(300, &A[0]) == Slice(300, AsPtrToConst(&B[0])));
+
+    B[299] = 0;
+    REQUIRE(Slice(300, &A[0]) != Slice(300, &B[0]));
+    REQUIRE(Slice(299, &A[0]) == Slice(299, &B[0]));
+  }
+
+  SECTION("Floating point")
+  {
+    // Compared per element, not per byte.
+    float A[] = { 0.0f, 1.0f };
+    float B[] = { -0.0f, 1.0f };
+    REQUIRE(Slice(A) == Slice(B));
+  }
+}
+
+TEST_CASE("Slice byte swap", "[Slice]")
+{
+  uint32 const FeatureMasks[] = { ~uint32(0), Cpu_SSE2 | Cpu_SSSE3, Cpu_SSE2 };
+  Defer [=](){ CpuRestrictFeatures(~uint32(0)); };
+
+  SECTION("All sizes")
+  {
+    uint16 Values16[101];
+    uint32 Values32[101];
+    uint64 Values64[101];
+
+    size_t NumMismatches = 0;
+    for(auto Mask : FeatureMasks)
+    {
+      CpuRestrictFeatures(Mask);
+      for(size_t Num = 0; Num <= 100; ++Num)
+      {
+        for(size_t Index = 0; Index < 101; ++Index)
+        {
+          Values16[Index] = uint16(0x0102 + Index);
+          Values32[Index] = uint32(0x01020304 + Index);
+          Values64[Index] = uint64(0x0102030405060708) + Index;
+        }
+
+        // Starting at the second element to test unaligned data.
+        SliceByteSwap(Slice(Num, &Values16[1]));
+        SliceByteSwap(Slice(Num, &Values32[1]));
+        SliceByteSwap(Slice(Num, &Values64[1]));
+        for(size_t Index = 0; Index < 101; ++Index)
+        {
+          auto const IsSwapped = Index >= 1 && Index <= Num;
+          if(Values16[Index] != (IsSwapped ? ByteSwap(uint16(0x0102 + Index)) : uint16(0x0102 + Index)))
+            ++NumMismatches;
+          if(Values32[Index] != (IsSwapped ? ByteSwap(uint32(0x01020304 + Index)) : uint32(0x01020304 + Index)))
+            ++NumMismatches;
+          if(Values64[Index] != (IsSwapped ? ByteSwap(uint64(0x0102030405060708) + Index) : uint64(0x0102030405060708) + Index))
+            ++NumMismatches;
+        }
+      }
+    }
+    REQUIRE( NumMismatches == 0 );
+  }
+
+  SECTION("Other element types")
+  {
+    int16 Ints[] = { 1, -2, 3 };
+    SliceByteSwap(Slice(Ints));
+    REQUIRE( Ints[0] == 0x0100 );
+    REQUIRE( Ints[1] == int16(0xFEFF) );
+
+    double Doubles[40];
+    for(int Index = 0; Index < 40; ++Index)
+      Doubles[Index] = Index * 0.5;
+    SliceByteSwap(Slice(Doubles));
+    REQUIRE( Doubles[1] != 0.5 );
+    SliceByteSwap(Slice(Doubles));
+    REQUIRE( Doubles[1] == 0.5 );
+    REQUIRE( Doubles[39] == 19.5 );
+  }
+
+  SECTION("Endianness conversion")
+  {
+    // Big-endian 32 bit values as they come over the wire.
+    uint8 Packet[] = { 0x00, 0x00, 0x00, 0x2A, 0xFF, 0xFF, 0xFF, 0xFE };
+    auto Values = SliceReinterpret<int32>(Slice(Packet));
+
+    SliceConvertEndian(Values, Endian_Native, Endian_Native);
+    REQUIRE( Values[0] == 0x2A000000 );
+
+    SliceConvertEndian(Values, Endian_Big, Endian_Native);
+    REQUIRE( Values[0] == 42 );
+    REQUIRE( Values[1] == -2 );
+
+    SliceConvertEndian(Values, Endian_Native, Endian_Big);
+    REQUIRE( Packet[3] == 0x2A );
+  }
 }
 
 TEST_CASE("Slice Searching", "[Slice]")
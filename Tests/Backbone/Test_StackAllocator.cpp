@@ -0,0 +1,126 @@
+#include <Backbone/StackAllocator.hpp>
+#include <Backbone/FixedBlock.hpp>
+#include <Backbone/Path.hpp>
+
+#include "catch.hpp"
+
+
+TEST_CASE("Stack allocation", "[StackAllocator]")
+{
+  fixed_block<128, uint8> Buffer;
+  stack_allocator Stack;
+  StackInit(&Stack, SliceReinterpret<void>(Slice(Buffer)));
+  Defer [&](){ StackFinalize(&Stack); };
+
+  REQUIRE( StackCapacity(Stack) == Bytes(128) );
+  REQUIRE( StackUsed(Stack) == Bytes(0) );
+
+  SECTION("LIFO free")
+  {
+    auto A = StackAllocate<int>(&Stack, 4, 1);
+    auto B = StackAllocate<int>(&Stack, 4, 2);
+    REQUIRE( A[3] == 1 );
+    REQUIRE( B[0] == 2 );
+    REQUIRE( StackUsed(Stack) == 8 * SizeOf<int>() );
+
+    StackFree(&Stack, B.Ptr);
+    REQUIRE( StackUsed(Stack) == 4 * SizeOf<int>() );
+
+    auto C = StackAllocate<int>(&Stack, 4, 3);
+    REQUIRE( C.Ptr == B.Ptr );
+
+    StackFree(&Stack, C.Ptr);
+    StackFree(&Stack, A.Ptr);
+    REQUIRE( StackUsed(Stack) == Bytes(0) );
+  }
+
+  SECTION("Free releases alignment padding")
+  {
+    StackAllocate<uint8>(&Stack, 3);
+    auto const Used = StackUsed(Stack);
+
+    auto A = StackAllocateBytes(&Stack, Bytes(16), 64);
+    REQUIRE( A != nullptr );
+    REQUIRE( IsAligned(A, 64) );
+    StackFree(&Stack, A);
+    REQUIRE( StackUsed(Stack) == Used );
+
+    // Several padded allocations in a row, freed in LIFO order.
+    auto B = StackAllocate<uint8>(&Stack, 1);
+    auto C = StackAllocate<uint32>(&Stack, 2);
+    auto D = StackAllocate<uint8>(&Stack, 1);
+    auto E = StackAllocate<uint64>(&Stack, 1);
+    REQUIRE( E.Ptr != nullptr );
+    StackFree(&Stack, E.Ptr);
+    StackFree(&Stack, D.Ptr);
+    auto const UsedBeforeC = Used + Bytes(1);
+    StackFree(&Stack, C.Ptr);
+    REQUIRE( StackUsed(Stack) == UsedBeforeC );
+    StackFree(&Stack, B.Ptr);
+    REQUIRE( StackUsed(Stack) == Used );
+
+    // Rolling back past padded allocations forgets them.
+    auto Marker = StackGetMarker(Stack);
+    StackAllocate<uint64>(&Stack, 1);
+    StackRollback(&Stack, Marker);
+    auto F = StackAllocateBytes(&Stack, Bytes(8), 1);
+    StackFree(&Stack, F);
+    REQUIRE( StackUsed(Stack) == Used );
+  }
+
+  SECTION("Markers")
+  {
+    StackAllocate<uint8>(&Stack, 3);
+    auto Marker = StackGetMarker(Stack);
+
+    StackAllocate<uint64>(&Stack, 4);
+    StackAllocate<uint8>(&Stack, 7);
+    REQUIRE( StackUsed(Stack) > Bytes(3) );
+
+    StackRollback(&Stack, Marker);
+    REQUIRE( StackUsed(Stack) == Bytes(3) );
+  }
+
+  SECTION("Out of memory")
+  {
+    REQUIRE( StackAllocate<uint8>(&Stack, 129).Ptr == nullptr );
+    REQUIRE( StackUsed(Stack) == Bytes(0) );
+  }
+
+  SECTION("Sizes that wrap around")
+  {
+    StackAllocate<uint8>(&Stack, 3);
+    REQUIRE( StackAllocateBytes(&Stack, Bytes(IntMaxValue<size_t>() - 1), 1) == nullptr );
+    REQUIRE( StackAllocate<uint64>(&Stack, IntMaxValue<size_t>() / 4).Ptr == nullptr );
+    REQUIRE( StackAllocateBytes(&Stack, Bytes(1), size_t(1) << 40) == nullptr );
+
+    auto Allocator = AllocatorFrom(&Stack);
+    auto Ptr = AllocatorAllocateBytes(Allocator, Bytes(8), 1);
+    REQUIRE( Ptr != nullptr );
+    REQUIRE( AllocatorReallocateBytes(Allocator, Ptr, Bytes(8), Bytes(IntMaxValue<size_t>() - 4), 1) == nullptr );
+    REQUIRE( StackUsed(Stack) == Bytes(11) );
+  }
+
+  SECTION("Scoped rollback")
+  {
+    StackAllocate<uint8>(&Stack, 5);
+
+    {
+      StackScope(&Stack);
+      auto PathBuffer = StackAllocate<char>(&Stack, 32);
+      auto Path = ConcatPaths("head"_S, "tail"_S, PathBuffer);
+      REQUIRE( Path == "head\\tail"_S );
+      REQUIRE( StackUsed(Stack) == Bytes(5 + 32) );
+
+      {
+        StackScope(&Stack);
+        StackAllocate<uint64>(&Stack, 2);
+        REQUIRE( StackUsed(Stack) > Bytes(5 + 32) );
+      }
+
+      REQUIRE( StackUsed(Stack) == Bytes(5 + 32) );
+    }
+
+    REQUIRE( StackUsed(Stack) == Bytes(5) );
+  }
+}
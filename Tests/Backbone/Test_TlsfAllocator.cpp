@@ -0,0 +1,204 @@
+#include <Backbone/TlsfAllocator.hpp>
+#include <Backbone/Heap.hpp>
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+
+TEST_CASE("TLSF allocator basics", "[TlsfAllocator]")
+{
+  auto Memory = MemAllocate(KiB(64));
+  Defer [&](){ MemFree(Memory); };
+
+  tlsf_allocator Tlsf;
+  TlsfInit(&Tlsf, Slice(Convert<size_t>(ToBytes(KiB(64))), Memory));
+  Defer [&](){ TlsfFinalize(&Tlsf); };
+
+  REQUIRE( TlsfCapacity(Tlsf) == KiB(64) );
+  REQUIRE( TlsfUsed(Tlsf) == Bytes(0) );
+
+  auto A = TlsfAllocateBytes(&Tlsf, Bytes(100), 1);
+  REQUIRE( A != nullptr );
+  REQUIRE( IsAligned(A, Tlsf_Alignment) );
+  REQUIRE( TlsfBlockSize(Tlsf, A) == Bytes(112) );
+  REQUIRE( TlsfUsed(Tlsf) == Bytes(112) );
+
+  auto B = TlsfAllocateBytes(&Tlsf, Bytes(0), 1);
+  REQUIRE( B != nullptr );
+  REQUIRE( B != A );
+
+  auto C = TlsfAllocateBytes(&Tlsf, KiB(10), 1);
+  REQUIRE( C != nullptr );
+  REQUIRE( TlsfBlockSize(Tlsf, C) >= KiB(10) );
+
+  // Too big.
+  REQUIRE( TlsfAllocateBytes(&Tlsf, KiB(64), 1) == nullptr );
+  REQUIRE( TlsfAllocate<uint64>(&Tlsf, IntMaxValue<size_t>() / 4).Ptr == nullptr );
+
+  TlsfFree(&Tlsf, B);
+  TlsfFree(&Tlsf, A);
+  TlsfFree(&Tlsf, C);
+  TlsfFree(&Tlsf, nullptr);
+  REQUIRE( TlsfUsed(Tlsf) == Bytes(0) );
+
+  // Everything merged back into a single block.
+  auto All = TlsfAllocateBytes(&Tlsf, KiB(60), 1);
+  REQUIRE( All == A );
+  TlsfFree(&Tlsf, All);
+}
+
+TEST_CASE("TLSF allocator alignment", "[TlsfAllocator]")
+{
+  auto Memory = MemAllocate(KiB(64));
+  Defer [&](){ MemFree(Memory); };
+
+  tlsf_allocator Tlsf;
+  TlsfInit(&Tlsf, Slice(Convert<size_t>(ToBytes(KiB(64))), Memory));
+  Defer [&](){ TlsfFinalize(&Tlsf); };
+
+  std::vector<void*> Allocations;
+  for(size_t Alignment = 1; Alignment <= 4096; Alignment *= 2)
+  {
+    CAPTURE( Alignment );
+    auto Ptr = TlsfAllocateBytes(&Tlsf, Bytes(24), Alignment);
+    REQUIRE( Ptr != nullptr );
+    REQUIRE( IsAligned(Ptr, Alignment) );
+    MemSetBytes(Bytes(24), Ptr, 0xAB);
+    Allocations.push_back(Ptr);
+  }
+
+  for(auto Ptr : Allocations)
+    TlsfFree(&Tlsf, Ptr);
+  REQUIRE( TlsfUsed(Tlsf) == Bytes(0) );
+
+  // The gaps in front of aligned blocks were merged back as well.
+  REQUIRE( TlsfAllocateBytes(&Tlsf, KiB(60), 1) != nullptr );
+}
+
+TEST_CASE("TLSF allocator random allocations", "[TlsfAllocator]")
+{
+  auto Memory = MemAllocate(MiB(1));
+  Defer [&](){ MemFree(Memory); };
+
+  tlsf_allocator Tlsf;
+  TlsfInit(&Tlsf, Slice(Convert<size_t>(ToBytes(MiB(1))), Memory));
+  Defer [&](){ TlsfFinalize(&Tlsf); };
+
+  allocation_stats Stats;
+  AllocStatsInit(&Stats);
+  Tlsf.Stats = &Stats;
+
+  struct allocation
+  {
+    uint8* Ptr;
+    size_t Size;
+    uint8 Pattern;
+  };
+
+  std::mt19937 Random(1337);
+  std::vector<allocation> Live;
+  for(int Iteration = 0; Iteration < 20000; ++Iteration)
+  {
+    if(Live.empty() || Random() % 3 != 0)
+    {
+      auto const Size = size_t(1) + Random() % 4096;
+      auto const Alignment = size_t(1) << (Random() % 8);
+      auto Ptr = Reinterpret<uint8*>(TlsfAllocateBytes(&Tlsf, Bytes(Size), Alignment));
+      if(Ptr == nullptr)
+        continue;
+
+      REQUIRE( IsAligned(Ptr, Alignment) );
+      REQUIRE( TlsfBlockSize(Tlsf, Ptr) >= Bytes(Size) );
+      auto const Pattern = uint8(Iteration);
+      MemSet(Size, Ptr, Pattern);
+      Live.push_back({ Ptr, Size, Pattern });
+    }
+    else
+    {
+      auto const Index = Random() % Live.size();
+      auto const Victim = Live[Index];
+      Live[Index] = Live.back();
+      Live.pop_back();
+
+      // Nobody else wrote to this block, including the allocator.
+      size_t NumOverwritten = 0;
+      for(size_t Offset = 0; Offset < Victim.Size; ++Offset)
+        NumOverwritten += Victim.Ptr[Offset] != Victim.Pattern;
+      REQUIRE( NumOverwritten == 0 );
+      TlsfFree(&Tlsf, Victim.Ptr);
+    }
+  }
+
+  for(auto& Allocation : Live)
+    TlsfFree(&Tlsf, Allocation.Ptr);
+
+  REQUIRE( TlsfUsed(Tlsf) == Bytes(0) );
+  REQUIRE( AllocStatsSnapshot(Stats).LiveSize == Bytes(0) );
+  REQUIRE( TlsfAllocateBytes(&Tlsf, KiB(1000), 1) != nullptr );
+}
+
+TEST_CASE("TLSF allocator latency benchmark", "[.][TlsfAllocator][Benchmark]")
+{
+  size_t const NumOperations = 1000000;
+  size_t const NumLive = 4096;
+
+  // The same random sequence of sizes and frees for every allocator.
+  std::mt19937 Random(42);
+  std::vector<size_t> Sizes(NumOperations);
+  std::vector<size_t> Victims(NumOperations);
+  for(size_t Index = 0; Index < NumOperations; ++Index)
+  {
+    Sizes[Index] = size_t(16) + Random() % 8192;
+    Victims[Index] = Random() % NumLive;
+  }
+
+  auto Measure = [&](char const* Name, auto Allocate, auto Free)
+  {
+    std::vector<void*> Live(NumLive, nullptr);
+    std::vector<double> Latencies(NumOperations);
+    for(size_t Index = 0; Index < NumOperations; ++Index)
+    {
+      auto& Slot = Live[Victims[Index]];
+      Free(Slot);
+
+      auto const Begin = std::chrono::high_resolution_clock::now();
+      Slot = Allocate(Sizes[Index]);
+      auto const End = std::chrono::high_resolution_clock::now();
+      Latencies[Index] = std::chrono::duration<double, std::nano>(End - Begin).count();
+    }
+    for(auto Ptr : Live)
+      Free(Ptr);
+
+    std::sort(Latencies.begin(), Latencies.end());
+    auto Percentile = [&](double P){ return Latencies[size_t(P * (NumOperations - 1))]; };
+    std::printf("  %-8s p50 %7.0f ns, p99 %7.0f ns, p99.9 %7.0f ns, max %9.0f ns\n",
+                Name, Percentile(0.5), Percentile(0.99), Percentile(0.999), Latencies.back());
+  };
+
+  std::printf("TLSF allocator latency benchmark (allocation time)\n");
+
+  auto const PoolSize = MiB(128);
+  auto Memory = MemAllocate(PoolSize);
+  Defer [&](){ MemFree(Memory); };
+
+  // Real-time code would not take page faults on its pool either.
+  MemSetBytes(PoolSize, Memory, 0);
+
+  tlsf_allocator Tlsf;
+  TlsfInit(&Tlsf, Slice(Convert<size_t>(ToBytes(PoolSize)), Memory));
+  Defer [&](){ TlsfFinalize(&Tlsf); };
+
+  Measure("TLSF",
+    [&](size_t Size){ return TlsfAllocateBytes(&Tlsf, Bytes(Size), 16); },
+    [&](void* Ptr){ TlsfFree(&Tlsf, Ptr); });
+
+  Measure("malloc",
+    [&](size_t Size){ return std::malloc(Size); },
+    [&](void* Ptr){ std::free(Ptr); });
+}
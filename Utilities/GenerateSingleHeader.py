@@ -59,6 +59,20 @@ def Generate(OutBasePath, BackboneRoot=None):
 // For std::numeric_limits
 #include <limits>
 
+// For std::atomic
+#include <atomic>
+
+// For std::is_trivially_*
+#include <type_traits>
+
+#if defined(BB_Platform_Windows)
+  // For _BitScanForward64, _BitScanReverse64
+  #include <intrin.h>
+
+  // For _byteswap_ushort, _byteswap_ulong, _byteswap_uint64
+  #include <stdlib.h>
+#endif
+
 """)
 
     FileName = Path("Backbone", "Common.hpp")
@@ -79,6 +93,24 @@ def Generate(OutBasePath, BackboneRoot=None):
       PrintIncludeOrigin(FileName)
       PrintLine(TheLines)
 
+    FileName = Path("Backbone", "VirtualMemory.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "AllocationStats.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "Allocator.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
     FileName = Path("Backbone", "Angle.hpp")
     with (CodePath / FileName).open("r") as File:
       TheLines = TransformLines(File.readlines())
@@ -103,6 +135,66 @@ def Generate(OutBasePath, BackboneRoot=None):
       PrintIncludeOrigin(FileName)
       PrintLine(TheLines)
 
+    FileName = Path("Backbone", "Arena.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "StackAllocator.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "Pool.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "Heap.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "BuddyAllocator.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "TlsfAllocator.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "MappedFile.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "RingBuffer.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "ConcurrentPool.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "Hash.hpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
     if SeparateInlineFile:
       assert False, "Not implemented."
     else:
@@ -135,6 +227,30 @@ def Generate(OutBasePath, BackboneRoot=None):
 
 #include <cmath>
 #include <cstring>
+#include <cstdlib>
+#include <cstddef>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#if defined(BB_Platform_Windows)
+  #include <windows.h>
+#elif defined(BB_Platform_Linux)
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <cstdio>
+#endif
+
+#if defined(BB_Platform_x64)
+  #include <immintrin.h>
+  #if defined(BB_Platform_Windows)
+    #include <intrin.h>
+  #else
+    #include <cpuid.h>
+  #endif
+#endif
 
 """)
 
@@ -156,6 +272,18 @@ def Generate(OutBasePath, BackboneRoot=None):
       PrintIncludeOrigin(FileName)
       PrintLine(TheLines)
 
+    FileName = Path("Backbone", "AllocationStats.cpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "Allocator.cpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
     FileName = Path("Backbone", "Angle.cpp")
     with (CodePath / FileName).open("r") as File:
       TheLines = TransformLines(File.readlines())
@@ -168,6 +296,66 @@ def Generate(OutBasePath, BackboneRoot=None):
       PrintIncludeOrigin(FileName)
       PrintLine(TheLines)
 
+    FileName = Path("Backbone", "Arena.cpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "StackAllocator.cpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "Pool.cpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "VirtualMemory.cpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "Heap.cpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "BuddyAllocator.cpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "TlsfAllocator.cpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "MappedFile.cpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "RingBuffer.cpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
+    FileName = Path("Backbone", "Hash.cpp")
+    with (CodePath / FileName).open("r") as File:
+      TheLines = TransformLines(File.readlines())
+      PrintIncludeOrigin(FileName)
+      PrintLine(TheLines)
+
 def Main():
   Parser = argparse.ArgumentParser(description="Pack all Backbone sources into as few source files as possible to make distribution easier.")
   Parser.add_argument("outpath",